@@ -23,7 +23,9 @@
 #include <blt/math/matrix.h>
 #include <blt/math/log_util.h>
 #include <algorithm>
+#include <charconv>
 #include <numeric>
+#include <string>
 #include <vector>
 
 namespace a1
@@ -53,6 +55,29 @@ namespace a1
         BLT_ASSERT(g1 * g2.transpose() == blt::vec4::dot(one, two) && "MATH DOT FAILURE");
     }
     
+    /**
+     * dot product of two row vectors without going through a 1x1 matrix product
+     */
+    template<blt::u32 size>
+    float dot(const blt::generalized_matrix<float, 1, size>& a, const blt::generalized_matrix<float, 1, size>& b)
+    {
+        float total = 0;
+        for (blt::u32 i = 0; i < size; i++)
+            total += a[i][0] * b[i][0];
+        return total;
+    }
+    
+    /**
+     * appends the shortest representation of value to str using std::to_chars
+     */
+    template<typename Str, typename T>
+    void append_number(Str& str, T value)
+    {
+        char buffer[64];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        str.append(buffer, result.ptr);
+    }
+    
     template<typename T, blt::u32 size>
     struct vec_formatter
     {
@@ -63,22 +88,33 @@ namespace a1
             template<typename Arr>
             std::string format(const Arr& has_index_changed)
             {
-                using namespace blt::logging;
                 std::string os;
+                append_to(os, has_index_changed);
+                return os;
+            }
+            
+            /**
+             * appends the formatted vector to any string type, numbers are written without going through a stringstream
+             */
+            template<typename Str, typename Arr>
+            void append_to(Str& os, const Arr& has_index_changed)
+            {
+                using namespace blt::logging;
+                static const std::string underline = ansi::make_color(ansi::UNDERLINE);
+                static const std::string reset_underline = ansi::make_color(ansi::RESET_UNDERLINE);
                 for (auto [index, value] : blt::enumerate(data))
                 {
                     if (value >= 0)
                         os += ' ';
                     if (has_index_changed[index])
-                        os += ansi::make_color(ansi::UNDERLINE);
-                    os += blt::logging::to_string_stream(value);
+                        os.append(underline.data(), underline.size());
+                    append_number(os, value);
                     if (has_index_changed[index])
-                        os += ansi::make_color(ansi::RESET_UNDERLINE);
+                        os.append(reset_underline.data(), reset_underline.size());
                     
                     if (index != size - 1)
                         os += ", ";
                 }
-                return os;
             }
         
         private:
@@ -0,0 +1,146 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef COSC_4P80_ASSIGNMENT_1_ARENA_H
+#define COSC_4P80_ASSIGNMENT_1_ARENA_H
+
+#include <blt/std/types.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace a1
+{
+    /**
+     * Bump allocator for memory that lives exactly as long as one run. Individual deallocations are ignored, reset() rewinds to
+     * the first block in O(1) and keeps every block around so the next run of the same shape never touches the global allocator.
+     */
+    class arena
+    {
+        public:
+            explicit arena(blt::size_t block_size = 64 * 1024): block_size(block_size)
+            {}
+            
+            arena(const arena&) = delete;
+            
+            arena& operator=(const arena&) = delete;
+            
+            [[nodiscard]] void* allocate(blt::size_t bytes, blt::size_t alignment)
+            {
+                while (current_block < blocks.size())
+                {
+                    if (auto ptr = try_fit(blocks[current_block], bytes, alignment))
+                        return ptr;
+                    current_block++;
+                    offset = 0;
+                }
+                // over-allocate so the request still fits after aligning the start of the block
+                auto size = std::max(block_size, bytes + alignment);
+                blocks.push_back({std::make_unique<std::byte[]>(size), size});
+                current_block = blocks.size() - 1;
+                offset = 0;
+                return try_fit(blocks.back(), bytes, alignment);
+            }
+            
+            void reset()
+            {
+                current_block = 0;
+                offset = 0;
+            }
+            
+            [[nodiscard]] blt::size_t capacity() const
+            {
+                blt::size_t total = 0;
+                for (const auto& block : blocks)
+                    total += block.size;
+                return total;
+            }
+        
+        private:
+            struct block_t
+            {
+                std::unique_ptr<std::byte[]> data;
+                blt::size_t size;
+            };
+            
+            void* try_fit(block_t& block, blt::size_t bytes, blt::size_t alignment)
+            {
+                auto base = reinterpret_cast<std::uintptr_t>(block.data.get());
+                auto aligned = ((base + offset + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1)) - base;
+                if (aligned + bytes > block.size)
+                    return nullptr;
+                offset = aligned + bytes;
+                return block.data.get() + aligned;
+            }
+            
+            blt::size_t block_size;
+            std::vector<block_t> blocks;
+            blt::size_t current_block = 0;
+            blt::size_t offset = 0;
+    };
+    
+    template<typename T>
+    class arena_allocator
+    {
+        public:
+            using value_type = T;
+            
+            explicit arena_allocator(arena& source): source(&source)
+            {}
+            
+            template<typename U>
+            arena_allocator(const arena_allocator<U>& other): source(other.get_arena()) // NOLINT
+            {}
+            
+            [[nodiscard]] T* allocate(blt::size_t n)
+            {
+                return static_cast<T*>(source->allocate(n * sizeof(T), alignof(T)));
+            }
+            
+            void deallocate(T*, blt::size_t)
+            {}
+            
+            [[nodiscard]] arena* get_arena() const
+            {
+                return source;
+            }
+            
+            friend bool operator==(const arena_allocator& a, const arena_allocator& b)
+            {
+                return a.source == b.source;
+            }
+            
+            friend bool operator!=(const arena_allocator& a, const arena_allocator& b)
+            {
+                return a.source != b.source;
+            }
+        
+        private:
+            arena* source;
+    };
+    
+    template<typename T>
+    using arena_vector = std::vector<T, arena_allocator<T>>;
+    
+    using arena_string = std::basic_string<char, std::char_traits<char>, arena_allocator<char>>;
+}
+
+#endif //COSC_4P80_ASSIGNMENT_1_ARENA_H
@@ -0,0 +1,121 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef COSC_4P80_ASSIGNMENT_1_BITPACK_H
+#define COSC_4P80_ASSIGNMENT_1_BITPACK_H
+
+#include <blt/math/matrix.h>
+#include <array>
+
+namespace a1
+{
+    /**
+     * Bipolar state packed one neuron per bit, set where the value is >= 0 to match bipolar(). Padding bits are always zero so
+     * whole words can be compared and XORed.
+     */
+    template<blt::u32 size>
+    struct packed_bits
+    {
+        static constexpr blt::u32 word_count = (size + 63) / 64;
+        blt::u64 words[word_count]{};
+        
+        friend bool operator==(const packed_bits& a, const packed_bits& b)
+        {
+            blt::u64 diff = 0;
+            for (blt::u32 w = 0; w < word_count; w++)
+                diff |= a.words[w] ^ b.words[w];
+            return diff == 0;
+        }
+        
+        friend bool operator!=(const packed_bits& a, const packed_bits& b)
+        {
+            return !(a == b);
+        }
+    };
+    
+    template<blt::u32 size>
+    packed_bits<size> pack(const blt::generalized_matrix<float, 1, size>& v)
+    {
+        packed_bits<size> bits;
+        for (blt::u32 i = 0; i < size; i++)
+            bits.words[i / 64] |= static_cast<blt::u64>(v[i][0] >= 0) << (i % 64);
+        return bits;
+    }
+    
+    /**
+     * inverse of pack, set bits become 1 and clear bits -1
+     */
+    template<blt::u32 size>
+    blt::generalized_matrix<float, 1, size> unpack(const packed_bits<size>& bits)
+    {
+        blt::generalized_matrix<float, 1, size> v;
+        for (blt::u32 i = 0; i < size; i++)
+            v[i][0] = (bits.words[i / 64] >> (i % 64)) & 1 ? 1.0f : -1.0f;
+        return v;
+    }
+    
+    template<blt::u32 size>
+    blt::u32 hamming(const packed_bits<size>& a, const packed_bits<size>& b)
+    {
+        blt::u32 distance = 0;
+        for (blt::u32 w = 0; w < packed_bits<size>::word_count; w++)
+            distance += static_cast<blt::u32>(__builtin_popcountll(a.words[w] ^ b.words[w]));
+        return distance;
+    }
+    
+    /**
+     * out[i] = hamming(a[i], b[i]) for count pairs
+     */
+    template<blt::u32 size>
+    void hamming_pairs(const packed_bits<size>* a, const packed_bits<size>* b, blt::size_t count, blt::u32* out)
+    {
+        for (blt::size_t i = 0; i < count; i++)
+            out[i] = hamming(a[i], b[i]);
+    }
+    
+    /**
+     * Row-major probe_count x pattern_count matrix of distances, out[p * pattern_count + s] = hamming(probes[p], patterns[s]).
+     * The stored patterns are the inner loop since there are usually far fewer of them and they stay in cache.
+     */
+    template<blt::u32 size>
+    void hamming_matrix(const packed_bits<size>* probes, blt::size_t probe_count, const packed_bits<size>* patterns, blt::size_t pattern_count,
+                        blt::u32* out)
+    {
+        for (blt::size_t p = 0; p < probe_count; p++)
+        {
+            const auto& probe = probes[p];
+            auto row = out + p * pattern_count;
+            for (blt::size_t s = 0; s < pattern_count; s++)
+                row[s] = hamming(probe, patterns[s]);
+        }
+    }
+    
+    /**
+     * @return number of pairs at each distance 0..size between a[i] and b[i], entry 0 is the number of exact matches
+     */
+    template<blt::u32 size>
+    std::array<blt::size_t, size + 1> hamming_histogram(const packed_bits<size>* a, const packed_bits<size>* b, blt::size_t count)
+    {
+        std::array<blt::size_t, size + 1> histogram{};
+        for (blt::size_t i = 0; i < count; i++)
+            histogram[hamming(a[i], b[i])]++;
+        return histogram;
+    }
+}
+
+#endif //COSC_4P80_ASSIGNMENT_1_BITPACK_H
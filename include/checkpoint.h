@@ -0,0 +1,280 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef COSC_4P80_ASSIGNMENT_1_CHECKPOINT_H
+#define COSC_4P80_ASSIGNMENT_1_CHECKPOINT_H
+
+#include <blt/std/logging.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace a1
+{
+    /**
+     * @return seed of the index-th independent random stream derived from base (splitmix64), so a campaign can restart any run
+     * exactly by recording only the base seed and the next run index
+     */
+    inline blt::u64 stream_seed(blt::u64 base, blt::u64 index)
+    {
+        blt::u64 z = base + (index + 1) * 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+    
+    enum class load_result_t
+    {
+        // nothing to resume, the campaign starts from scratch
+        FRESH,
+        RESUMED,
+        // the path holds something that is not a checkpoint, it must not be overwritten
+        INVALID
+    };
+    
+    /**
+     * Flat key / value store persisted as a small text file. Saves go to a temporary file which is renamed over the old
+     * checkpoint, so an interruption mid-save leaves the previous checkpoint intact. Bulky per-item records go to an append-only
+     * log next to it instead, so a save only ever rewrites the small map however long the campaign runs. A checkpoint without a
+     * path does nothing.
+     */
+    class checkpoint
+    {
+        public:
+            checkpoint() = default;
+            
+            explicit checkpoint(std::string path): path(std::move(path))
+            {}
+            
+            [[nodiscard]] bool enabled() const
+            {
+                return !path.empty();
+            }
+            
+            /**
+             * Reads a previous checkpoint. Without one the log is started afresh, unless either file exists and belongs to
+             * something else, which is reported as INVALID so the caller stops before a save destroys it.
+             */
+            load_result_t load()
+            {
+                values.clear();
+                if (!enabled())
+                    return load_result_t::FRESH;
+                std::ifstream file(path);
+                if (!file)
+                    return open_log(true) ? load_result_t::FRESH : load_result_t::INVALID;
+                std::string line;
+                if (!std::getline(file, line) || line != header)
+                {
+                    BLT_ERROR("'%s' exists but is not a checkpoint, refusing to overwrite it", path.c_str());
+                    return load_result_t::INVALID;
+                }
+                while (std::getline(file, line))
+                {
+                    auto split = line.find(' ');
+                    if (split == std::string::npos)
+                        continue;
+                    values[line.substr(0, split)] = line.substr(split + 1);
+                }
+                return open_log(false) ? load_result_t::RESUMED : load_result_t::INVALID;
+            }
+            
+            void save() const
+            {
+                if (!enabled())
+                    return;
+                auto temp_path = path + ".tmp";
+                {
+                    std::ofstream file(temp_path, std::ios::trunc);
+                    file << header << '\n';
+                    for (const auto& [key, value] : values)
+                        file << key << ' ' << value << '\n';
+                    file.flush();
+                    if (!file)
+                    {
+                        BLT_ERROR("Failed to write checkpoint '%s'", temp_path.c_str());
+                        return;
+                    }
+                }
+                if (std::rename(temp_path.c_str(), path.c_str()) != 0)
+                    BLT_ERROR("Failed to replace checkpoint '%s'", path.c_str());
+            }
+            
+            /**
+             * appends lines, each ending in a newline, to the log. Records must be safe to repeat, anything appended after the last
+             * save is appended again when the campaign resumes
+             */
+            void append_log(const std::string& lines) const
+            {
+                if (!enabled())
+                    return;
+                std::ofstream log(log_path(), std::ios::app);
+                log << lines;
+                log.flush();
+                if (!log)
+                    BLT_ERROR("Failed to append to checkpoint log '%s'", log_path().c_str());
+            }
+            
+            [[nodiscard]] std::vector<std::string> read_log() const
+            {
+                std::vector<std::string> lines;
+                if (!enabled())
+                    return lines;
+                std::ifstream log(log_path());
+                std::string line;
+                if (!std::getline(log, line) || line != log_header)
+                    return lines;
+                while (std::getline(log, line))
+                    lines.push_back(line);
+                return lines;
+            }
+            
+            [[nodiscard]] bool has(const std::string& key) const
+            {
+                return values.find(key) != values.end();
+            }
+            
+            void set(const std::string& key, const std::string& value)
+            {
+                values[key] = value;
+            }
+            
+            void set(const std::string& key, blt::u64 value)
+            {
+                values[key] = std::to_string(value);
+            }
+            
+            void set(const std::string& key, double value)
+            {
+                // hex floats round-trip exactly
+                char buffer[64];
+                std::snprintf(buffer, sizeof(buffer), "%a", value);
+                values[key] = buffer;
+            }
+            
+            [[nodiscard]] std::string get(const std::string& key, const std::string& fallback = {}) const
+            {
+                auto it = values.find(key);
+                return it == values.end() ? fallback : it->second;
+            }
+            
+            [[nodiscard]] blt::u64 get_u64(const std::string& key, blt::u64 fallback = 0) const
+            {
+                auto it = values.find(key);
+                return it == values.end() ? fallback : std::strtoull(it->second.c_str(), nullptr, 10);
+            }
+            
+            [[nodiscard]] double get_double(const std::string& key, double fallback = 0) const
+            {
+                auto it = values.find(key);
+                return it == values.end() ? fallback : std::strtod(it->second.c_str(), nullptr);
+            }
+        
+        private:
+            [[nodiscard]] std::string log_path() const
+            {
+                return path + ".log";
+            }
+            
+            /**
+             * Makes sure the log exists and starts with its header, emptying it first when the campaign starts afresh. An existing
+             * file without the header belongs to something else and is left alone.
+             */
+            [[nodiscard]] bool open_log(bool restart) const
+            {
+                {
+                    std::ifstream existing(log_path());
+                    std::string line;
+                    if (existing && !(std::getline(existing, line) && line == log_header))
+                    {
+                        BLT_ERROR("'%s' exists but is not a checkpoint log, refusing to overwrite it", log_path().c_str());
+                        return false;
+                    }
+                    if (existing && !restart)
+                        return true;
+                }
+                std::ofstream log(log_path(), std::ios::trunc);
+                log << log_header << '\n';
+                if (!log)
+                    BLT_ERROR("Failed to start checkpoint log '%s'", log_path().c_str());
+                return true;
+            }
+            
+            static constexpr const char* header = "a1-checkpoint 1";
+            static constexpr const char* log_header = "a1-checkpoint-log 1";
+            std::string path;
+            std::map<std::string, std::string> values;
+    };
+    
+    /**
+     * Welford mean / variance with min and max, constant size so it can be checkpointed instead of every sample
+     */
+    struct running_stats
+    {
+        blt::u64 count = 0;
+        double mean = 0;
+        double m2 = 0;
+        double min = std::numeric_limits<double>::max();
+        double max = std::numeric_limits<double>::lowest();
+        
+        void push(double value)
+        {
+            count++;
+            auto delta = value - mean;
+            mean += delta / static_cast<double>(count);
+            m2 += delta * (value - mean);
+            min = std::min(min, value);
+            max = std::max(max, value);
+        }
+        
+        /**
+         * @return population standard deviation
+         */
+        [[nodiscard]] double stddev() const
+        {
+            return count == 0 ? 0 : std::sqrt(m2 / static_cast<double>(count));
+        }
+        
+        void save(checkpoint& state, const std::string& prefix) const
+        {
+            state.set(prefix + ".count", count);
+            state.set(prefix + ".mean", mean);
+            state.set(prefix + ".m2", m2);
+            state.set(prefix + ".min", min);
+            state.set(prefix + ".max", max);
+        }
+        
+        void load(const checkpoint& state, const std::string& prefix)
+        {
+            count = state.get_u64(prefix + ".count", count);
+            mean = state.get_double(prefix + ".mean", mean);
+            m2 = state.get_double(prefix + ".m2", m2);
+            min = state.get_double(prefix + ".min", min);
+            max = state.get_double(prefix + ".max", max);
+        }
+    };
+}
+
+#endif //COSC_4P80_ASSIGNMENT_1_CHECKPOINT_H
@@ -0,0 +1,280 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef COSC_4P80_ASSIGNMENT_1_SHARD_H
+#define COSC_4P80_ASSIGNMENT_1_SHARD_H
+
+#include <blt/std/logging.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace a1
+{
+    struct shard_range_t
+    {
+        blt::size_t begin = 0;
+        blt::size_t end = 0;
+    };
+    
+    /**
+     * splits [0, total) into shards contiguous ranges whose sizes differ by at most one
+     */
+    inline shard_range_t shard_range(blt::size_t total, blt::size_t shards, blt::size_t index)
+    {
+        auto base = total / shards;
+        auto extra = total % shards;
+        auto begin = index * base + std::min(index, extra);
+        return {begin, begin + base + (index < extra ? 1 : 0)};
+    }
+    
+    /**
+     * Anonymous MAP_SHARED mapping. Anything written before a fork is visible to the worker, and anything the worker writes is
+     * visible to the coordinator once the worker has exited.
+     */
+    template<typename T>
+    class shared_buffer
+    {
+        public:
+            explicit shared_buffer(blt::size_t size): size_(size)
+            {
+                if (size_ == 0)
+                    return;
+                auto mapping = mmap(nullptr, size_ * sizeof(T), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+                if (mapping == MAP_FAILED)
+                {
+                    BLT_ERROR("Failed to map %ld bytes of shared memory: %s", size_ * sizeof(T), std::strerror(errno));
+                    size_ = 0;
+                    return;
+                }
+                data_ = static_cast<T*>(mapping);
+            }
+            
+            shared_buffer(const shared_buffer&) = delete;
+            
+            shared_buffer& operator=(const shared_buffer&) = delete;
+            
+            ~shared_buffer()
+            {
+                if (data_ != nullptr)
+                    munmap(data_, size_ * sizeof(T));
+            }
+            
+            [[nodiscard]] bool valid() const
+            {
+                return data_ != nullptr;
+            }
+            
+            [[nodiscard]] T* data()
+            {
+                return data_;
+            }
+            
+            [[nodiscard]] const T* data() const
+            {
+                return data_;
+            }
+            
+            [[nodiscard]] blt::size_t size() const
+            {
+                return size_;
+            }
+        
+        private:
+            T* data_ = nullptr;
+            blt::size_t size_;
+    };
+    
+    namespace detail
+    {
+        inline bool write_all(int fd, const void* buffer, blt::size_t bytes)
+        {
+            auto ptr = static_cast<const char*>(buffer);
+            while (bytes > 0)
+            {
+                auto written = write(fd, ptr, bytes);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return false;
+                }
+                ptr += written;
+                bytes -= static_cast<blt::size_t>(written);
+            }
+            return true;
+        }
+        
+        inline bool read_all(int fd, void* buffer, blt::size_t bytes)
+        {
+            auto ptr = static_cast<char*>(buffer);
+            while (bytes > 0)
+            {
+                auto amount = read(fd, ptr, bytes);
+                if (amount < 0 && errno == EINTR)
+                    continue;
+                if (amount <= 0)
+                    return false;
+                ptr += amount;
+                bytes -= static_cast<blt::size_t>(amount);
+            }
+            return true;
+        }
+        
+        inline bool wait_for_worker(pid_t pid)
+        {
+            int status = 0;
+            while (waitpid(pid, &status, 0) < 0)
+            {
+                if (errno != EINTR)
+                    return false;
+            }
+            return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        }
+    }
+    
+    /**
+     * Runs func(shard_range_t) for each slice of [0, total) in its own forked worker process and waits for all of them. Workers
+     * communicate only through memory the caller shares with them (see shared_buffer). Any slice whose worker could not be
+     * started or did not exit cleanly is run again in the calling process, so the call always completes.
+     */
+    template<typename Func>
+    void run_workers(blt::size_t total, blt::size_t workers, Func&& func)
+    {
+        workers = std::min(std::max(workers, static_cast<blt::size_t>(1)), total);
+        if (workers == 0)
+            return;
+        
+        // children exit with _exit, but anything buffered before the fork would otherwise be written twice
+        std::cout.flush();
+        
+        std::vector<pid_t> pids(workers, -1);
+        for (blt::size_t i = 0; i < workers; i++)
+        {
+            pids[i] = fork();
+            if (pids[i] == 0)
+            {
+                // an exception must never unwind out of the child, it would carry on running the rest of the program
+                try
+                {
+                    func(shard_range(total, workers, i));
+                } catch (...)
+                {
+                    _exit(1);
+                }
+                _exit(0);
+            }
+            if (pids[i] < 0)
+                BLT_WARN("Failed to fork worker %ld: %s, running its shard locally", i, std::strerror(errno));
+        }
+        
+        for (blt::size_t i = 0; i < workers; i++)
+        {
+            if (pids[i] > 0 && detail::wait_for_worker(pids[i]))
+                continue;
+            if (pids[i] > 0)
+                BLT_WARN("Worker %ld did not exit cleanly, running its shard locally", i);
+            func(shard_range(total, workers, i));
+        }
+    }
+    
+    /**
+     * Runs func(shard_range_t) -> std::vector<float> of result_size for each slice of [0, total) in forked workers, which send their
+     * partial results back over a pipe. The coordinator sums the partials element-wise.
+     */
+    template<typename Func>
+    std::vector<float> reduce_workers(blt::size_t total, blt::size_t workers, blt::size_t result_size, Func&& func)
+    {
+        std::vector<float> result(result_size, 0.0f);
+        workers = std::min(std::max(workers, static_cast<blt::size_t>(1)), total);
+        if (workers == 0)
+            return result;
+        
+        auto accumulate = [&result](const std::vector<float>& partial) {
+            for (blt::size_t i = 0; i < result.size(); i++)
+                result[i] += partial[i];
+        };
+        
+        std::cout.flush();
+        
+        struct worker_t
+        {
+            pid_t pid = -1;
+            int read_fd = -1;
+        };
+        std::vector<worker_t> running(workers);
+        for (blt::size_t i = 0; i < workers; i++)
+        {
+            int fds[2];
+            if (pipe(fds) != 0)
+            {
+                BLT_WARN("Failed to open pipe for worker %ld: %s, running its shard locally", i, std::strerror(errno));
+                continue;
+            }
+            auto pid = fork();
+            if (pid == 0)
+            {
+                close(fds[0]);
+                auto sent = false;
+                try
+                {
+                    auto partial = func(shard_range(total, workers, i));
+                    sent = partial.size() == result_size && detail::write_all(fds[1], partial.data(), result_size * sizeof(float));
+                } catch (...)
+                {}
+                close(fds[1]);
+                _exit(sent ? 0 : 1);
+            }
+            close(fds[1]);
+            if (pid < 0)
+            {
+                BLT_WARN("Failed to fork worker %ld: %s, running its shard locally", i, std::strerror(errno));
+                close(fds[0]);
+                continue;
+            }
+            running[i] = {pid, fds[0]};
+        }
+        
+        std::vector<float> partial(result_size);
+        for (blt::size_t i = 0; i < workers; i++)
+        {
+            auto& worker = running[i];
+            if (worker.pid > 0)
+            {
+                // drain the pipe before waiting, a worker blocks on write if its partial does not fit in the pipe buffer
+                auto received = detail::read_all(worker.read_fd, partial.data(), result_size * sizeof(float));
+                close(worker.read_fd);
+                if (detail::wait_for_worker(worker.pid) && received)
+                {
+                    accumulate(partial);
+                    continue;
+                }
+                BLT_WARN("Worker %ld did not send its partial result, running its shard locally", i);
+            }
+            accumulate(func(shard_range(total, workers, i)));
+        }
+        return result;
+    }
+}
+
+#endif //COSC_4P80_ASSIGNMENT_1_SHARD_H
@@ -0,0 +1,224 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef COSC_4P80_ASSIGNMENT_1_SPARSE_H
+#define COSC_4P80_ASSIGNMENT_1_SPARSE_H
+
+#include <blt/math/matrix.h>
+#include <blt/std/assert.h>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace a1
+{
+    /**
+     * fixed capacity list of neuron indices, so finding the active neurons of a pattern never touches the allocator
+     */
+    template<blt::u32 capacity>
+    struct active_indices_t
+    {
+        std::array<blt::u32, capacity> indices{};
+        blt::u32 count = 0;
+        
+        [[nodiscard]] const blt::u32* begin() const
+        {
+            return indices.data();
+        }
+        
+        [[nodiscard]] const blt::u32* end() const
+        {
+            return indices.data() + count;
+        }
+        
+        [[nodiscard]] blt::u32 size() const
+        {
+            return count;
+        }
+    };
+    
+    /**
+     * @return indices of a row vector whose value differs from background, the only neurons a sparse-coded pattern needs to visit
+     */
+    template<blt::u32 size>
+    active_indices_t<size> active_indices(const blt::generalized_matrix<float, 1, size>& v, float background = -1)
+    {
+        active_indices_t<size> active;
+        for (blt::u32 i = 0; i < size; i++)
+        {
+            if (v[i][0] != background)
+                active.indices[active.count++] = i;
+        }
+        return active;
+    }
+    
+    /**
+     * Weight matrix with entries at or below a magnitude threshold pruned, stored both row-compressed (for xW) and
+     * column-compressed (for yW^T) so recall in either direction only walks the surviving weights.
+     */
+    template<blt::u32 rows, blt::u32 columns>
+    class sparse_matrix
+    {
+        public:
+            using dense_t = blt::generalized_matrix<float, rows, columns>;
+            using row_vector_t = blt::generalized_matrix<float, 1, rows>;
+            using column_vector_t = blt::generalized_matrix<float, 1, columns>;
+            
+            explicit sparse_matrix(const dense_t& dense, float threshold = 0)
+            {
+                row_offsets.reserve(rows + 1);
+                column_offsets.reserve(columns + 1);
+                
+                row_offsets.push_back(0);
+                for (blt::u32 i = 0; i < rows; i++)
+                {
+                    for (blt::u32 j = 0; j < columns; j++)
+                    {
+                        if (std::abs(dense[j][i]) <= threshold)
+                            continue;
+                        row_indices.push_back(j);
+                        row_values.push_back(dense[j][i]);
+                        column_sums[j] += dense[j][i];
+                    }
+                    row_offsets.push_back(static_cast<blt::u32>(row_values.size()));
+                }
+                
+                column_offsets.push_back(0);
+                for (blt::u32 j = 0; j < columns; j++)
+                {
+                    for (blt::u32 i = 0; i < rows; i++)
+                    {
+                        if (std::abs(dense[j][i]) <= threshold)
+                            continue;
+                        column_indices.push_back(i);
+                        column_values.push_back(dense[j][i]);
+                    }
+                    column_offsets.push_back(static_cast<blt::u32>(column_values.size()));
+                }
+            }
+            
+            /**
+             * @return x * W
+             */
+            [[nodiscard]] column_vector_t multiply_rows(const row_vector_t& x) const
+            {
+                column_vector_t result;
+                for (blt::u32 i = 0; i < rows; i++)
+                {
+                    auto value = x[i][0];
+                    if (value == 0)
+                        continue;
+                    for (auto k = row_offsets[i]; k < row_offsets[i + 1]; k++)
+                        result[row_indices[k]][0] += value * row_values[k];
+                }
+                return result;
+            }
+            
+            /**
+             * @return y * W^T
+             */
+            [[nodiscard]] row_vector_t multiply_columns(const column_vector_t& y) const
+            {
+                row_vector_t result;
+                for (blt::u32 j = 0; j < columns; j++)
+                {
+                    auto value = y[j][0];
+                    if (value == 0)
+                        continue;
+                    for (auto k = column_offsets[j]; k < column_offsets[j + 1]; k++)
+                        result[column_indices[k]][0] += value * column_values[k];
+                }
+                return result;
+            }
+            
+            /**
+             * x * W for a bipolar x which equals background everywhere except at the active indices. Starting from the precomputed
+             * background response only the active rows are visited, so the cost scales with the activity instead of the size of x.
+             */
+            [[nodiscard]] column_vector_t multiply_rows_active(const active_indices_t<rows>& active, float background = -1) const
+            {
+                column_vector_t result;
+                for (blt::u32 j = 0; j < columns; j++)
+                    result[j][0] = background * column_sums[j];
+                for (auto i : active)
+                {
+                    for (auto k = row_offsets[i]; k < row_offsets[i + 1]; k++)
+                        result[row_indices[k]][0] -= 2 * background * row_values[k];
+                }
+                return result;
+            }
+            
+            [[nodiscard]] blt::size_t non_zeros() const
+            {
+                return row_values.size();
+            }
+            
+            [[nodiscard]] double density() const
+            {
+                return static_cast<double>(non_zeros()) / static_cast<double>(rows * columns);
+            }
+            
+            [[nodiscard]] static constexpr blt::size_t dense_bytes()
+            {
+                return sizeof(float) * rows * columns;
+            }
+            
+            /**
+             * @return bytes held by both compressed layouts and the background response
+             */
+            [[nodiscard]] blt::size_t sparse_bytes() const
+            {
+                return (row_offsets.size() + column_offsets.size() + row_indices.size() + column_indices.size()) * sizeof(blt::u32) +
+                       (row_values.size() + column_values.size()) * sizeof(float) + sizeof(column_sums);
+            }
+        
+        private:
+            // CSR, one entry per input row
+            std::vector<blt::u32> row_offsets;
+            std::vector<blt::u32> row_indices;
+            std::vector<float> row_values;
+            // CSC, one entry per output column
+            std::vector<blt::u32> column_offsets;
+            std::vector<blt::u32> column_indices;
+            std::vector<float> column_values;
+            // response of an all-ones input, used by the sparse pattern kernel
+            std::array<float, columns> column_sums{};
+    };
+    
+    /**
+     * every kernel must reproduce the dense products exactly when nothing is pruned
+     */
+    inline void test_sparse()
+    {
+        blt::generalized_matrix<float, 3, 2> dense{
+                blt::vec<float, 3>{1, 0, -3},
+                blt::vec<float, 3>{2, -1, 0}
+        };
+        sparse_matrix<3, 2> sparse{dense};
+        
+        blt::generalized_matrix<float, 1, 3> x{-1, 1, -1};
+        blt::generalized_matrix<float, 1, 2> y{1, -1};
+        
+        BLT_ASSERT(sparse.multiply_rows(x) == x * dense && "SPARSE ROW FAILURE");
+        BLT_ASSERT(sparse.multiply_columns(y) == y * dense.transpose() && "SPARSE COLUMN FAILURE");
+        BLT_ASSERT(sparse.multiply_rows_active(active_indices(x)) == x * dense && "SPARSE ACTIVE ROW FAILURE");
+        BLT_ASSERT(sparse.non_zeros() == 4 && "SPARSE PRUNE FAILURE");
+    }
+}
+
+#endif //COSC_4P80_ASSIGNMENT_1_SPARSE_H
@@ -1,5 +1,11 @@
 #include <iostream>
+#include <optional>
+#include <limits>
+#include <cctype>
+#include <cerrno>
 #include <utility>
+#include <vector>
+#include <cstdio>
 #include <blt/math/matrix.h>
 #include <blt/math/log_util.h>
 #include <blt/std/assert.h>
@@ -8,16 +14,52 @@
 #include <blt/iterator/iterator.h>
 #include <blt/parse/argparse.h>
 #include <a1.h>
+#include <shard.h>
+#include <arena.h>
+#include <sparse.h>
+#include <bitpack.h>
+#include <checkpoint.h>
+#include <chrono>
 
 constexpr blt::u32 input_vec_size = 5;
 constexpr blt::u32 output_vec_size = 4;
+// number of noisy probes corrected by part D
+constexpr blt::size_t part_d_runs = 80;
 
 bool print_latex = false;
+// number of worker processes used for weight generation and batched recall, 1 keeps everything in process
+blt::size_t worker_count = 1;
+// progress of the part C / part D campaign, does nothing unless a checkpoint path is given
+a1::checkpoint campaign;
+// number of part D runs between checkpoints
+blt::size_t checkpoint_interval = 10;
 
 using input_t = a1::matrix_t<1, input_vec_size>;
 using output_t = a1::matrix_t<1, output_vec_size>;
 using weight_t = decltype(std::declval<input_t>().transpose() * std::declval<output_t>());
 
+constexpr blt::size_t weight_size = input_vec_size * output_vec_size;
+using sparse_weight_t = a1::sparse_matrix<input_vec_size, output_vec_size>;
+using packed_input_t = a1::packed_bits<input_vec_size>;
+using packed_output_t = a1::packed_bits<output_vec_size>;
+
+// flat layout used to move weights between processes, one output column after another
+void store_weights(const weight_t& weights, float* flat)
+{
+    for (blt::size_t j = 0; j < output_vec_size; j++)
+        for (blt::size_t i = 0; i < input_vec_size; i++)
+            flat[j * input_vec_size + i] = weights[j][i];
+}
+
+weight_t load_weights(const float* flat)
+{
+    weight_t weights;
+    for (blt::size_t j = 0; j < output_vec_size; j++)
+        for (blt::size_t i = 0; i < input_vec_size; i++)
+            weights[j][i] = flat[j * input_vec_size + i];
+    return weights;
+}
+
 template<typename Os, typename T, blt::u32 size>
 Os& print_vec_square(Os& o, const blt::vec<T, size>& v)
 {
@@ -40,22 +82,67 @@ struct correctness_t
     blt::size_t incorrect_output = 0;
 };
 
+void print_correctness(const correctness_t& data)
+{
+    BLT_TRACE("Correct inputs  %ld Incorrect inputs  %ld | (%lf%%)", data.correct_input, data.incorrect_input,
+              static_cast<double>(data.correct_input * 100) / static_cast<double>(data.incorrect_input + data.correct_input));
+    BLT_TRACE("Correct outputs %ld Incorrect outputs %ld | (%lf%%)", data.correct_output, data.incorrect_output,
+              static_cast<double>(data.correct_output * 100) / static_cast<double>(data.incorrect_output + data.correct_output));
+    BLT_TRACE("Total correct   %ld Total incorrect   %ld | (%lf%%)", data.correct_input + data.correct_output,
+              data.incorrect_input + data.incorrect_output,
+              static_cast<double>(data.correct_input + data.correct_output) * 100 /
+              static_cast<double>(data.correct_input + data.correct_output + data.incorrect_input + data.incorrect_output));
+}
+
+enum class update_schedule_t
+{
+    // every neuron on one side is updated at once from the other side
+    SYNCHRONOUS,
+    // one neuron at a time, alternating between the input and output layers
+    ASYNCHRONOUS,
+    // blocks of neurons at a time, alternating between the input and output layers
+    BLOCK_SEQUENTIAL
+};
+
 class ping_pong
 {
     public:
         ping_pong(weight_t weights, input_t input, output_t output): weights(std::move(weights)), input(std::move(input)), output(std::move(output))
         {}
         
-        [[nodiscard]] ping_pong run_step_from_inputs() const
+        [[nodiscard]] ping_pong run_step_from_inputs(update_schedule_t schedule = update_schedule_t::SYNCHRONOUS, blt::size_t block_size = 1) const
         {
+            switch (schedule)
+            {
+                case update_schedule_t::ASYNCHRONOUS:
+                    return run_sweep(true, 1);
+                case update_schedule_t::BLOCK_SEQUENTIAL:
+                    return run_sweep(true, block_size);
+                default:
+                    break;
+            }
             auto out = (input * weights);
-            return {weights, (out * weights.transpose()).bipolar(), out.bipolar()};
+            auto next_output = out.bipolar();
+            auto next_input = (out * weights.transpose()).bipolar();
+            // xW gives E(x, y) and E(x, y') for one dot product each, E(x', y') is read off the next step's xW the same way
+            return {weights, next_input, next_output, -a1::dot(out, output), -a1::dot(out, next_output), operations + synchronous_step_cost};
         }
         
-        [[nodiscard]] ping_pong run_step_from_outputs() const
+        [[nodiscard]] ping_pong run_step_from_outputs(update_schedule_t schedule = update_schedule_t::SYNCHRONOUS, blt::size_t block_size = 1) const
         {
+            switch (schedule)
+            {
+                case update_schedule_t::ASYNCHRONOUS:
+                    return run_sweep(false, 1);
+                case update_schedule_t::BLOCK_SEQUENTIAL:
+                    return run_sweep(false, block_size);
+                default:
+                    break;
+            }
             auto in = (output * weights.transpose());
-            return {weights, in.bipolar(), (in * weights).bipolar()};
+            auto next_input = in.bipolar();
+            auto next_output = (in * weights).bipolar();
+            return {weights, next_input, next_output, -a1::dot(in, input), -a1::dot(in, next_input), operations + synchronous_step_cost};
         }
         
         [[nodiscard]] const input_t& get_input() const
@@ -68,6 +155,65 @@ class ping_pong
             return output;
         }
         
+        /**
+         * @return BAM energy E = -x W y^T of this state. A synchronous step only learns it from the field of the step after it, so
+         * it is NaN until resolve_energy() or finish_energy() has run. The executor does this for every state it stores.
+         */
+        [[nodiscard]] float get_energy() const
+        {
+            return energy.value_or(std::numeric_limits<float>::quiet_NaN());
+        }
+        
+        /**
+         * @return energy after the first half of the step which produced this state, equal to get_energy() for initial states and
+         * asynchronous / block-sequential sweeps
+         */
+        [[nodiscard]] float get_half_step_energy() const
+        {
+            return previous_energy ? half_step_energy : get_energy();
+        }
+        
+        /**
+         * @return energy of the state this one was stepped from, which every step gets from its first field for one dot product.
+         * Empty for initial states.
+         */
+        [[nodiscard]] const std::optional<float>& get_previous_energy() const
+        {
+            return previous_energy;
+        }
+        
+        /**
+         * records the energy of this state from next, the state stepped from it
+         */
+        void resolve_energy(const ping_pong& next)
+        {
+            if (!energy)
+                energy = next.previous_energy;
+        }
+        
+        /**
+         * Resolves the energy of the final state of a run, which nothing was stepped from. A converged state repeats previous so its
+         * energy is already known, only a state stopped early by an energy tolerance pays for one product.
+         */
+        void finish_energy(const ping_pong& previous)
+        {
+            if (energy)
+                return;
+            if (*this == previous && previous_energy)
+                energy = previous_energy;
+            else
+                energy = -a1::dot(input * weights, output);
+        }
+        
+        /**
+         * @return number of multiply-adds and neuron evaluations the recall spent reaching this state from the initial one. Energy
+         * tracking is monitoring rather than recall, so it is not counted for any schedule.
+         */
+        [[nodiscard]] blt::size_t get_operations() const
+        {
+            return operations;
+        }
+        
         friend bool operator==(const ping_pong& a, const ping_pong& b)
         {
             return a.input == b.input && a.output == b.output;
@@ -79,39 +225,195 @@ class ping_pong
         }
     
     private:
+        // two full products plus thresholding both layers
+        static constexpr blt::size_t synchronous_step_cost = 2 * input_vec_size * output_vec_size + input_vec_size + output_vec_size;
+        // both fields from scratch, thresholding the primed layer is charged where it happens
+        static constexpr blt::size_t field_priming_cost = 2 * input_vec_size * output_vec_size;
+        
+        ping_pong(weight_t weights, input_t input, output_t output, float previous_energy, float half_step_energy, blt::size_t operations):
+                weights(std::move(weights)), input(std::move(input)), output(std::move(output)), previous_energy(previous_energy),
+                half_step_energy(half_step_energy), operations(operations)
+        {}
+        
+        /**
+         * One sweep over both layers, block_size neurons at a time, alternating sides. The fields xW and yW^T are kept up to date
+         * incrementally so flipping an input neuron costs O(M) and flipping an output neuron costs O(N) instead of a full product.
+         */
+        [[nodiscard]] ping_pong run_sweep(bool inputs_first, blt::size_t block_size) const
+        {
+            ping_pong next = *this;
+            // a state produced by a sweep already knows its energy, otherwise the priming field gives it for one dot product
+            auto source_energy = energy;
+            if (!next.has_fields)
+            {
+                // prime the opposite side synchronously once so the sweep does not start from an unrelated state
+                if (inputs_first)
+                {
+                    next.output_field = input * weights;
+                    source_energy = -a1::dot(next.output_field, output);
+                    next.output = next.output_field.bipolar();
+                    next.input_field = next.output * weights.transpose();
+                    next.operations += field_priming_cost + output_vec_size;
+                } else
+                {
+                    next.input_field = output * weights.transpose();
+                    source_energy = -a1::dot(next.input_field, input);
+                    next.input = next.input_field.bipolar();
+                    next.output_field = next.input * weights;
+                    next.operations += field_priming_cost + input_vec_size;
+                }
+                next.has_fields = true;
+            }
+            
+            block_size = std::max(block_size, static_cast<blt::size_t>(1));
+            for (blt::size_t block = 0; block < std::max(input_vec_size, output_vec_size); block += block_size)
+            {
+                if (inputs_first)
+                {
+                    next.update_input_block(block, block_size);
+                    next.update_output_block(block, block_size);
+                } else
+                {
+                    next.update_output_block(block, block_size);
+                    next.update_input_block(block, block_size);
+                }
+            }
+            
+            next.energy = -a1::dot(next.input, next.input_field);
+            next.previous_energy = source_energy;
+            next.half_step_energy = *next.energy;
+            return next;
+        }
+        
+        void update_input_block(blt::size_t begin, blt::size_t block_size)
+        {
+            auto end = std::min(begin + block_size, static_cast<blt::size_t>(input_vec_size));
+            std::array<float, input_vec_size> deltas{};
+            // neurons within one layer do not feed each other, so a block reads the field before applying any of its flips
+            for (blt::size_t i = begin; i < end; i++)
+            {
+                auto value = input_field[i][0] >= 0 ? 1.0f : -1.0f;
+                deltas[i] = value - input[i][0];
+                input[i][0] = value;
+                operations++;
+            }
+            for (blt::size_t i = begin; i < end; i++)
+            {
+                if (deltas[i] == 0)
+                    continue;
+                for (blt::size_t j = 0; j < output_vec_size; j++)
+                    output_field[j][0] += deltas[i] * weights[j][i];
+                operations += output_vec_size;
+            }
+        }
+        
+        void update_output_block(blt::size_t begin, blt::size_t block_size)
+        {
+            auto end = std::min(begin + block_size, static_cast<blt::size_t>(output_vec_size));
+            std::array<float, output_vec_size> deltas{};
+            for (blt::size_t j = begin; j < end; j++)
+            {
+                auto value = output_field[j][0] >= 0 ? 1.0f : -1.0f;
+                deltas[j] = value - output[j][0];
+                output[j][0] = value;
+                operations++;
+            }
+            for (blt::size_t j = begin; j < end; j++)
+            {
+                if (deltas[j] == 0)
+                    continue;
+                for (blt::size_t i = 0; i < input_vec_size; i++)
+                    input_field[i][0] += deltas[j] * weights[j][i];
+                operations += input_vec_size;
+            }
+        }
+        
         weight_t weights;
         input_t input;
         output_t output;
+        std::optional<float> energy;
+        std::optional<float> previous_energy;
+        float half_step_energy = 0;
+        // yW^T and xW, only valid for states produced by a sweep
+        input_t input_field;
+        output_t output_field;
+        bool has_fields = false;
+        blt::size_t operations = 0;
 };
 
+// patterns with fewer than half their neurons away from -1 only walk the rows of their active neurons
+output_t sparse_output_field(const sparse_weight_t& sparse, const input_t& x)
+{
+    auto active = a1::active_indices(x);
+    if (active.size() * 2 < input_vec_size)
+        return sparse.multiply_rows_active(active);
+    return sparse.multiply_rows(x);
+}
+
+// pings of every pair at one point in the execution
+using step_t = a1::arena_vector<ping_pong>;
+
 class executor
 {
     public:
         executor(const std::vector<input_t>& inputs, const std::vector<output_t>& outputs): weights(), inputs(inputs), outputs(outputs)
         {
+            for (auto [in, out] : blt::in_pairs(inputs, outputs))
+            {
+                packed_inputs.push_back(a1::pack(in));
+                packed_outputs.push_back(a1::pack(out));
+            }
             generate_weights();
         }
         
         void add_pattern(input_t input, output_t output)
         {
+            packed_inputs.push_back(a1::pack(input));
+            packed_outputs.push_back(a1::pack(output));
             inputs.push_back(std::move(input));
             outputs.push_back(std::move(output));
         }
         
         void generate_weights()
         {
+            if (worker_count > 1)
+            {
+                generate_weights_sharded(worker_count);
+                return;
+            }
             for (auto [in, out] : blt::in_pairs(inputs, outputs))
                 weights += in.transpose() * out;
         }
         
+        /**
+         * Each worker process sums the outer products of its slice of the training pairs and pipes the partial matrix back,
+         * where the partials are reduced into the weights.
+         */
+        void generate_weights_sharded(blt::size_t workers)
+        {
+            auto summed = a1::reduce_workers(inputs.size(), workers, weight_size, [this](a1::shard_range_t range) {
+                weight_t partial;
+                for (auto i = range.begin; i < range.end; i++)
+                    partial += inputs[i].transpose() * outputs[i];
+                std::vector<float> flat(weight_size);
+                store_weights(partial, flat.data());
+                return flat;
+            });
+            weights += load_weights(summed.data());
+        }
+        
         void print_weights() const
         {
             BLT_TRACE_STREAM << "Weight Matrix: \n" << weights << "\n";
         }
         
-        [[nodiscard]] std::vector<output_t> crosstalk() const
+        /**
+         * @return crosstalk vector of every input, drawn from the scratch arena and only valid until it is next rewound
+         */
+        [[nodiscard]] a1::arena_vector<output_t> crosstalk() const
         {
-            std::vector<output_t> crosstalk_data;
+            scratch_arena->reset();
+            a1::arena_vector<output_t> crosstalk_data{a1::arena_allocator<output_t>{*scratch_arena}};
             crosstalk_data.resize(outputs.size());
             
             std::cout << "\\begin{tabular}{||c|c|c|c|c||}\n\\hline\n";
@@ -169,10 +471,10 @@ class executor
             BLT_TRACE("Total Crosstalk: %f", total_talk);
         }
         
-        void execute_input()
+        void execute_input(update_schedule_t schedule = update_schedule_t::SYNCHRONOUS, blt::size_t block_size = 1)
         {
-            steps.clear();
-            std::vector<ping_pong> initial_pings;
+            begin_run();
+            step_t initial_pings{step_t::allocator_type{*run_arena}};
             initial_pings.reserve(inputs.size());
             for (auto [input, output] : blt::in_pairs(inputs, outputs))
                 initial_pings.emplace_back(weights, input, output);
@@ -181,18 +483,19 @@ class executor
             do
             {
                 auto& prev = steps.rbegin()[0];
-                std::vector<ping_pong> next_pongs;
+                step_t next_pongs{step_t::allocator_type{*run_arena}};
                 next_pongs.reserve(prev.size());
                 for (auto& ping : prev)
-                    next_pongs.emplace_back(ping.run_step_from_inputs());
+                    next_pongs.emplace_back(ping.run_step_from_inputs(schedule, block_size));
                 steps.emplace_back(std::move(next_pongs));
-            } while (steps.rbegin()[0] != steps.rbegin()[1]);
+            } while (!has_converged(steps.rbegin()[1], steps.rbegin()[0]));
+            finish_run();
         }
         
-        void execute_output()
+        void execute_output(update_schedule_t schedule = update_schedule_t::SYNCHRONOUS, blt::size_t block_size = 1)
         {
-            steps.clear();
-            std::vector<ping_pong> initial_pings;
+            begin_run();
+            step_t initial_pings{step_t::allocator_type{*run_arena}};
             initial_pings.reserve(outputs.size());
             for (auto [input, output] : blt::in_pairs(inputs, outputs))
                 initial_pings.emplace_back(weights, input, output);
@@ -201,130 +504,256 @@ class executor
             do
             {
                 auto& prev = steps.rbegin()[0];
-                std::vector<ping_pong> next_pongs;
+                step_t next_pongs{step_t::allocator_type{*run_arena}};
                 next_pongs.reserve(prev.size());
                 for (auto& ping : prev)
-                    next_pongs.emplace_back(ping.run_step_from_outputs());
+                    next_pongs.emplace_back(ping.run_step_from_outputs(schedule, block_size));
                 steps.emplace_back(std::move(next_pongs));
-            } while (steps.rbegin()[0] != steps.rbegin()[1]);
+            } while (!has_converged(steps.rbegin()[1], steps.rbegin()[0]));
+            finish_run();
         }
         
         [[nodiscard]] input_t correct(const input_t& v) const
+        {
+            return recall(v).get_input();
+        }
+        
+        [[nodiscard]] ping_pong recall(const input_t& v, update_schedule_t schedule = update_schedule_t::SYNCHRONOUS, blt::size_t block_size = 1) const
         {
             // outputs here do not matter.
             ping_pong current{weights, v, outputs.front()};
-            ping_pong next{weights, v, outputs.front()};
-            do
+            auto next = current.run_step_from_inputs(schedule, block_size);
+            // run until stability
+            while (!has_converged(current, next))
             {
                 current = next;
-                next = current.run_step_from_inputs();
-                // run until stability
-            } while (current != next);
-            return next.get_input();
+                next = current.run_step_from_inputs(schedule, block_size);
+            }
+            return next;
         }
         
-        [[nodiscard]] correctness_t correctness() const
+        /**
+         * Corrects count probes into corrected, spreading them across worker processes. Workers already see the final weights
+         * through fork, so only their results travel back through a shared mapping. The caller owns both buffers so they can
+         * live in whatever arena it resets between batches.
+         */
+        void correct_sharded(const input_t* probes, blt::size_t count, input_t* corrected, blt::size_t workers) const
         {
-            correctness_t results;
-            for (auto [i, data] : blt::zip(inputs, outputs, steps.back()).enumerate())
+            auto correct_locally = [&]() {
+                for (blt::size_t i = 0; i < count; i++)
+                    corrected[i] = correct(probes[i]);
+            };
+            if (workers <= 1)
+                return correct_locally();
+            
+            a1::shared_buffer<float> shared_results(count * input_vec_size);
+            if (!shared_results.valid())
+                return correct_locally();
+            
+            a1::run_workers(count, workers, [&](a1::shard_range_t range) {
+                for (auto i = range.begin; i < range.end; i++)
+                {
+                    auto result = correct(probes[i]);
+                    for (blt::size_t j = 0; j < input_vec_size; j++)
+                        shared_results.data()[i * input_vec_size + j] = result[j][0];
+                }
+            });
+            
+            for (blt::size_t i = 0; i < count; i++)
             {
-                auto& [input_data, output_data, ping_ping] = data;
-                
-                if (input_data == ping_ping.get_input())
-                    results.correct_input++;
-                else
-                    results.incorrect_input++;
+                for (blt::size_t j = 0; j < input_vec_size; j++)
+                    corrected[i][j][0] = shared_results.data()[i * input_vec_size + j];
+            }
+        }
+        
+        /**
+         * @param threshold weights with a magnitude at or below this are pruned
+         */
+        [[nodiscard]] sparse_weight_t make_sparse_weights(float threshold = 0) const
+        {
+            return sparse_weight_t{weights, threshold};
+        }
+        
+        /**
+         * Synchronous recall from the input side on the dense weights, the same loop as correct_sparse() without the energy and
+         * operation bookkeeping of recall(), so the two can be timed against each other.
+         */
+        [[nodiscard]] input_t correct_dense(const input_t& v) const
+        {
+            input_t current_input = v;
+            output_t current_output = outputs.front();
+            while (true)
+            {
+                auto field = current_input * weights;
+                auto next_output = field.bipolar();
+                auto next_input = (field * weights.transpose()).bipolar();
+                if (next_input == current_input && next_output == current_output)
+                    return next_input;
+                current_input = next_input;
+                current_output = next_output;
+            }
+        }
+        
+        /**
+         * synchronous recall from the input side using compressed weights, matches correct() when nothing has been pruned.
+         * Like run_step_from_inputs the raw xW field is fed back through W^T, only the bipolar probe can use the active kernel.
+         */
+        [[nodiscard]] input_t correct_sparse(const input_t& v, const sparse_weight_t& sparse) const
+        {
+            input_t current_input = v;
+            output_t current_output = outputs.front();
+            while (true)
+            {
+                auto field = sparse_output_field(sparse, current_input);
+                auto next_output = field.bipolar();
+                auto next_input = sparse.multiply_columns(field).bipolar();
+                if (next_input == current_input && next_output == current_output)
+                    return next_input;
+                current_input = next_input;
+                current_output = next_output;
+            }
+        }
+        
+        /**
+         * @return operations spent by every pair of the last execution to reach its final state
+         */
+        [[nodiscard]] blt::size_t total_operations() const
+        {
+            blt::size_t total = 0;
+            for (const auto& pong : steps.back())
+                total += pong.get_operations();
+            return total;
+        }
+        
+        /**
+         * Stop execution once the energy of every pair moves by no more than tolerance between two steps, instead of waiting
+         * for the states to stop changing. Exact state equality always counts as converged. Energies are only known one step
+         * behind the recall, so a tolerance stop happens one step after the energy settles.
+         */
+        void set_energy_tolerance(float tolerance)
+        {
+            energy_tolerance = tolerance;
+        }
+        
+        void clear_energy_tolerance()
+        {
+            energy_tolerance.reset();
+        }
+        
+        /**
+         * @return energy of each pair over the last execution, interleaved as [E0, E0.5, E1, E1.5, E2, ...]. Drawn from the scratch
+         * arena and only valid until it is next rewound.
+         */
+        [[nodiscard]] a1::arena_vector<a1::arena_vector<float>> energy_history() const
+        {
+            scratch_arena->reset();
+            a1::arena_allocator<float> allocator{*scratch_arena};
+            a1::arena_vector<a1::arena_vector<float>> history{allocator};
+            if (steps.empty())
+                return history;
+            history.reserve(steps.front().size());
+            for (blt::size_t i = 0; i < steps.front().size(); i++)
+            {
+                history.emplace_back(allocator);
+                history.back().reserve(steps.size() * 2);
+            }
+            for (auto [step_index, step] : blt::enumerate(steps))
+            {
+                for (auto [index, pong] : blt::enumerate(step))
+                {
+                    if (step_index != 0)
+                        history[index].push_back(pong.get_half_step_energy());
+                    history[index].push_back(pong.get_energy());
+                }
+            }
+            return history;
+        }
+        
+        void print_energy() const
+        {
+            // the line is drawn from the scratch arena after the history, which rewinds it
+            auto history = energy_history();
+            a1::arena_string line{a1::arena_allocator<char>{*scratch_arena}};
+            for (auto [index, energies] : blt::enumerate(history))
+            {
+                bool increased = false;
+                for (blt::size_t i = 1; i < energies.size(); i++)
+                    increased |= energies[i] > energies[i - 1];
                 
-                if (output_data == ping_ping.get_output())
-                    results.correct_output++;
-                else
-                    results.incorrect_output++;
+                line.clear();
+                line += "Pair ";
+                a1::append_number(line, index);
+                line += " energy: ";
+                for (auto [i, e] : blt::enumerate(energies))
+                {
+                    a1::append_number(line, e);
+                    if (i != energies.size() - 1)
+                        line += (i % 2 == 0 ? " -> " : " => ");
+                }
+                if (increased)
+                    line += " (energy increased!)";
+                BLT_TRACE_STREAM << line.c_str() << "\n";
             }
+        }
+        
+        [[nodiscard]] correctness_t correctness() const
+        {
+            auto input_histogram = input_distance_histogram();
+            auto output_histogram = output_distance_histogram();
+            
+            correctness_t results;
+            results.correct_input = input_histogram[0];
+            results.incorrect_input = steps.back().size() - input_histogram[0];
+            results.correct_output = output_histogram[0];
+            results.incorrect_output = steps.back().size() - output_histogram[0];
             return results;
         }
         
+        /**
+         * @return number of pairs whose final input is each hamming distance away from the stored input, entry 0 counts correct pairs
+         */
+        [[nodiscard]] std::array<blt::size_t, input_vec_size + 1> input_distance_histogram() const
+        {
+            return a1::hamming_histogram(final_inputs.data(), packed_inputs.data(), final_inputs.size());
+        }
+        
+        [[nodiscard]] std::array<blt::size_t, output_vec_size + 1> output_distance_histogram() const
+        {
+            return a1::hamming_histogram(final_outputs.data(), packed_outputs.data(), final_outputs.size());
+        }
+        
+        /**
+         * out[p * pattern_count() + s] = hamming distance from probes[p] to stored input s, for count already packed probes
+         */
+        void distance_matrix(const packed_input_t* probes, blt::size_t count, blt::u32* out) const
+        {
+            a1::hamming_matrix(probes, count, packed_inputs.data(), packed_inputs.size(), out);
+        }
+        
+        [[nodiscard]] blt::size_t pattern_count() const
+        {
+            return inputs.size();
+        }
+        
         void print_correctness() const
         {
-            auto data = correctness();
-            
-            BLT_TRACE("Correct inputs  %ld Incorrect inputs  %ld | (%lf%%)", data.correct_input, data.incorrect_input,
-                      static_cast<double>(data.correct_input * 100) / static_cast<double>(data.incorrect_input + data.correct_input));
-            BLT_TRACE("Correct outputs %ld Incorrect outputs %ld | (%lf%%)", data.correct_output, data.incorrect_output,
-                      static_cast<double>(data.correct_output * 100) / static_cast<double>(data.incorrect_output + data.correct_output));
-            BLT_TRACE("Total correct   %ld Total incorrect   %ld | (%lf%%)", data.correct_input + data.correct_output,
-                      data.incorrect_input + data.incorrect_output,
-                      static_cast<double>(data.correct_input + data.correct_output) * 100 /
-                      static_cast<double>(data.correct_input + data.correct_output + data.incorrect_input + data.incorrect_output));
+            ::print_correctness(correctness());
         }
         
-        void print_execution_results_latex_no_intermediates()
+        void print_execution_results_latex_no_intermediates() const
         {
             std::cout << "\\begin{longtable}{||";
             for (blt::size_t i = 0; i < 4; i++)
                 std::cout << "c|";
             std::cout << "|}\n\t\\hline\n";
             std::cout << "\tType & Input Vectors & Result Vectors & Result\\\\\n\t\\hline\\hline\n";
-            
-            std::vector<std::string> input_lines;
-            std::vector<std::string> output_lines;
-            input_lines.resize(inputs.size());
-            output_lines.resize(outputs.size());
-            
-            for (auto [i, is] : blt::enumerate(input_lines))
-                (is += "Input ") += std::to_string(i + 1);
-            for (auto [i, os] : blt::enumerate(output_lines))
-                (os += "Output ") += std::to_string(i + 1);
-            
-            for (const auto& [step_idx, step] : blt::enumerate(steps))
-            {
-                for (auto [idx, pong] : blt::enumerate(step))
-                {
-                    if (!(step_idx == 0 || step_idx == steps.size()-1))
-                        break;
-                    auto& is = input_lines[idx];
-                    auto& os = output_lines[idx];
-                    
-                    is += " & ";
-                    os += " & ";
-                    
-                    std::stringstream stream;
-                    print_vec_square(stream, pong.get_input().vec_from_column_row());
-                    is += stream.str();
-                    stream = {};
-                    print_vec_square(stream, pong.get_output().vec_from_column_row());
-                    os += stream.str();
-                }
-            }
-            auto result = steps.back();
-            for (auto [idx, ping] : blt::zip(result, inputs, outputs).enumerate())
-            {
-                auto [pong, input, output] = ping;
-                auto& is = input_lines[idx];
-                auto& os = output_lines[idx];
-                
-                is += " & ";
-                os += " & ";
-                
-                if (pong.get_input() == input)
-                    is += "Correct";
-                else
-                    is += "Incorrect";
-                if (pong.get_output() == output)
-                    os += "Correct";
-                else
-                    os += "Incorrect";
-            }
-            for (auto [is, os] : blt::in_pairs(input_lines, output_lines))
-            {
-                std::cout << '\t' << is << " \\\\\n\t\\hline\n";
-                std::cout << '\t' << os << " \\\\\n\t\\hline\n";
-            }
+            print_execution_rows_latex(false);
             std::cout << "\t\\caption{}\n";
             std::cout << "\t\\label{tbl:}\n";
             std::cout << "\\end{longtable}\n";
         }
         
-        void print_execution_results_latex()
+        void print_execution_results_latex() const
         {
             std::cout << "\\begin{longtable}{||";
             for (blt::size_t i = 0; i < steps.size() + 3; i++)
@@ -332,92 +761,43 @@ class executor
             std::cout << "|}\n\t\\hline\n";
             std::cout << "\tType & Input Vectors & \\multicolumn{" << steps.size() - 2
                       << "}{|c|}{Intermediate Vectors} & Result Vectors & Result\\\\\n\t\\hline\\hline\n";
-            
-            std::vector<std::string> input_lines;
-            std::vector<std::string> output_lines;
-            input_lines.resize(inputs.size());
-            output_lines.resize(outputs.size());
-            
-            for (auto [i, is] : blt::enumerate(input_lines))
-                (is += "Input ") += std::to_string(i + 1);
-            for (auto [i, os] : blt::enumerate(output_lines))
-                (os += "Output ") += std::to_string(i + 1);
-            
-            for (const auto& step : steps)
-            {
-                for (auto [idx, pong] : blt::enumerate(step))
-                {
-                    auto& is = input_lines[idx];
-                    auto& os = output_lines[idx];
-                    
-                    is += " & ";
-                    os += " & ";
-                    
-                    std::stringstream stream;
-                    print_vec_square(stream, pong.get_input().vec_from_column_row());
-                    is += stream.str();
-                    stream = {};
-                    print_vec_square(stream, pong.get_output().vec_from_column_row());
-                    os += stream.str();
-                }
-            }
-            auto result = steps.back();
-            for (auto [idx, ping] : blt::zip(result, inputs, outputs).enumerate())
-            {
-                auto [pong, input, output] = ping;
-                auto& is = input_lines[idx];
-                auto& os = output_lines[idx];
-                
-                is += " & ";
-                os += " & ";
-                
-                if (pong.get_input() == input)
-                    is += "Correct";
-                else
-                    is += "Incorrect";
-                if (pong.get_output() == output)
-                    os += "Correct";
-                else
-                    os += "Incorrect";
-            }
-            for (auto [is, os] : blt::in_pairs(input_lines, output_lines))
-            {
-                std::cout << '\t' << is << " \\\\\n\t\\hline\n";
-                std::cout << '\t' << os << " \\\\\n\t\\hline\n";
-            }
+            print_execution_rows_latex(true);
             std::cout << "\t\\caption{}\n";
             std::cout << "\t\\label{tbl:}\n";
             std::cout << "\\end{longtable}\n";
         }
         
-        void print_execution_results()
+        void print_execution_results() const
         {
             using namespace blt::logging;
-            std::vector<std::string> input_lines;
-            std::vector<std::string> output_lines;
-            input_lines.resize(inputs.size());
-            output_lines.resize(outputs.size());
-            BLT_ASSERT(input_lines.size() == output_lines.size());
+            static const std::string green = ansi::make_color(ansi::GREEN);
+            static const std::string red = ansi::make_color(ansi::RED);
+            static const std::string reset = ansi::RESET;
+            
+            // one line per pair and side is built at a time, so both buffers keep their capacity in the scratch arena across pairs
+            scratch_arena->reset();
+            a1::arena_string is{a1::arena_allocator<char>{*scratch_arena}};
+            a1::arena_string os{a1::arena_allocator<char>{*scratch_arena}};
             
-            for (auto [i, data] : blt::in_pairs(input_lines, output_lines).enumerate())
+            BLT_TRACE("Changes between ping-pong steps are underlined.");
+            for (blt::size_t i = 0; i < inputs.size(); i++)
             {
-                auto& [is, os] = data;
+                const auto& ping_ping = steps.back()[i];
+                auto input_passed = inputs[i] == ping_ping.get_input();
+                auto output_passed = outputs[i] == ping_ping.get_output();
                 
-                auto ping_ping = steps.back()[i];
+                is.clear();
+                os.clear();
+                (is += input_passed ? green.c_str() : red.c_str()) += "[Input  ";
+                (os += output_passed ? green.c_str() : red.c_str()) += "[Output ";
+                a1::append_number(is, i);
+                a1::append_number(os, i);
+                (is += "]: ") += reset.c_str();
+                (os += "]: ") += reset.c_str();
                 
-                auto& input_data = inputs[i];
-                auto& output_data = outputs[i];
-                
-                ((((is += input_data == ping_ping.get_input() ? ansi::make_color(ansi::GREEN) : ansi::make_color(
-                        ansi::RED)) += "[Input  ") += std::to_string(i)) += "]: ") += ansi::RESET;
-                ((((os += output_data == ping_ping.get_output() ? ansi::make_color(ansi::GREEN) : ansi::make_color(
-                        ansi::RED)) += "[Output ") += std::to_string(i)) += "]: ") += ansi::RESET;
-            }
-            
-            for (auto [step_index, step_data] : blt::enumerate(steps))
-            {
-                for (auto [data_index, current_data] : blt::enumerate(step_data))
+                for (blt::size_t step_index = 0; step_index < steps.size(); step_index++)
                 {
+                    const auto& current_data = steps[step_index][i];
                     auto current_input = current_data.get_input().vec_from_column_row();
                     auto current_output = current_data.get_output().vec_from_column_row();
                     
@@ -426,7 +806,7 @@ class executor
                     
                     if (step_index > 0)
                     {
-                        auto& previous_data = steps[step_index - 1][data_index];
+                        auto& previous_data = steps[step_index - 1][i];
                         auto previous_input = previous_data.get_input().vec_from_column_row();
                         auto previous_output = previous_data.get_output().vec_from_column_row();
                         
@@ -436,14 +816,15 @@ class executor
                             has_output_changed[vec_index] = std::get<0>(data) != std::get<1>(data);
                     }
                     
-                    auto& is = input_lines[data_index];
-                    auto& os = output_lines[data_index];
-                    
-                    ((is += "Vec") += blt::logging::to_string_stream(decltype(current_input)::data_size)) += "(";
-                    ((os += "Vec") += blt::logging::to_string_stream(decltype(current_output)::data_size)) += "(";
+                    is += "Vec";
+                    os += "Vec";
+                    a1::append_number(is, decltype(current_input)::data_size);
+                    a1::append_number(os, decltype(current_output)::data_size);
+                    is += "(";
+                    os += "(";
                     
-                    is += a1::vec_formatter(current_input).format(has_input_changed);
-                    os += a1::vec_formatter(current_output).format(has_output_changed);
+                    a1::vec_formatter(current_input).append_to(is, has_input_changed);
+                    a1::vec_formatter(current_output).append_to(os, has_output_changed);
                     
                     is += ")";
                     os += ")";
@@ -467,45 +848,126 @@ class executor
                         os += " || ";
                     }
                 }
+                
+                ((is += input_passed ? green.c_str() : red.c_str()) += input_passed ? "[Passed]" : "[Failed]") += reset.c_str();
+                ((os += output_passed ? green.c_str() : red.c_str()) += output_passed ? "[Passed]" : "[Failed]") += reset.c_str();
+                
+                BLT_TRACE_STREAM << is.c_str() << "\n";
+                BLT_TRACE_STREAM << os.c_str() << "\n";
             }
-            
-            for (auto [index, ping_ping] : blt::enumerate(steps.back()))
+        }
+        
+        step_t& get_results()
+        {
+            return steps.back();
+        }
+    
+    private:
+        /**
+         * writes the input and output row of every pair straight to std::cout, only the first and last steps unless intermediates
+         */
+        void print_execution_rows_latex(bool intermediates) const
+        {
+            for (blt::size_t idx = 0; idx < inputs.size(); idx++)
             {
-                auto& is = input_lines[index];
-                auto& os = output_lines[index];
-                
-                auto& input_data = inputs[index];
-                auto& output_data = outputs[index];
+                const auto& result = steps.back()[idx];
                 
-                if (input_data != ping_ping.get_input())
-                    ((is += ansi::make_color(ansi::RED)) += "[Failed]") += ansi::RESET;
-                else
-                    ((is += ansi::make_color(ansi::GREEN)) += "[Passed]") += ansi::RESET;
+                std::cout << "\tInput " << idx + 1;
+                for (blt::size_t step_idx = 0; step_idx < steps.size(); step_idx++)
+                {
+                    if (!intermediates && !(step_idx == 0 || step_idx == steps.size() - 1))
+                        continue;
+                    std::cout << " & ";
+                    print_vec_square(std::cout, steps[step_idx][idx].get_input().vec_from_column_row());
+                }
+                std::cout << " & " << (result.get_input() == inputs[idx] ? "Correct" : "Incorrect") << " \\\\\n\t\\hline\n";
                 
-                if (output_data != ping_ping.get_output())
-                    ((os += ansi::make_color(ansi::RED)) += "[Failed]") += ansi::RESET;
-                else
-                    ((os += ansi::make_color(ansi::GREEN)) += "[Passed]") += ansi::RESET;
+                std::cout << "\tOutput " << idx + 1;
+                for (blt::size_t step_idx = 0; step_idx < steps.size(); step_idx++)
+                {
+                    if (!intermediates && !(step_idx == 0 || step_idx == steps.size() - 1))
+                        continue;
+                    std::cout << " & ";
+                    print_vec_square(std::cout, steps[step_idx][idx].get_output().vec_from_column_row());
+                }
+                std::cout << " & " << (result.get_output() == outputs[idx] ? "Correct" : "Incorrect") << " \\\\\n\t\\hline\n";
             }
-            
-            BLT_TRACE("Changes between ping-pong steps are underlined.");
-            for (auto [is, os] : blt::in_pairs(input_lines, output_lines))
+        }
+        
+        void begin_run()
+        {
+            // the previous run's steps live in the arena, release them before rewinding it
+            steps = a1::arena_vector<step_t>{a1::arena_allocator<step_t>{*run_arena}};
+            final_inputs = a1::arena_vector<packed_input_t>{a1::arena_allocator<packed_input_t>{*run_arena}};
+            final_outputs = a1::arena_vector<packed_output_t>{a1::arena_allocator<packed_output_t>{*run_arena}};
+            run_arena->reset();
+        }
+        
+        /**
+         * resolves the energies of the finished run and packs its final states once, so the distance kernels work on packed arrays
+         */
+        void finish_run()
+        {
+            resolve_energies();
+            final_inputs.reserve(steps.back().size());
+            final_outputs.reserve(steps.back().size());
+            for (const auto& pong : steps.back())
             {
-                BLT_TRACE_STREAM << is << "\n";
-                BLT_TRACE_STREAM << os << "\n";
+                final_inputs.push_back(a1::pack(pong.get_input()));
+                final_outputs.push_back(a1::pack(pong.get_output()));
             }
         }
         
-        std::vector<ping_pong>& get_results()
+        /**
+         * fills in the energy of every stored state from the step after it, only the last step can need a product of its own
+         */
+        void resolve_energies()
         {
-            return steps.back();
+            for (blt::size_t step_index = 0; step_index + 1 < steps.size(); step_index++)
+            {
+                for (blt::size_t i = 0; i < steps[step_index].size(); i++)
+                    steps[step_index][i].resolve_energy(steps[step_index + 1][i]);
+            }
+            if (steps.size() < 2)
+                return;
+            for (blt::size_t i = 0; i < steps.back().size(); i++)
+                steps.back()[i].finish_energy(steps.rbegin()[1][i]);
         }
-    
-    private:
+        
+        [[nodiscard]] bool has_converged(const ping_pong& prev, const ping_pong& next) const
+        {
+            if (prev == next)
+                return true;
+            // next only carries the energy of prev, so the tolerance compares prev against the state before it and stops one step late
+            auto& energy_after = next.get_previous_energy();
+            auto& energy_before = prev.get_previous_energy();
+            return energy_tolerance && energy_after && energy_before && std::abs(*energy_after - *energy_before) <= *energy_tolerance;
+        }
+        
+        [[nodiscard]] bool has_converged(const step_t& prev, const step_t& next) const
+        {
+            for (auto [a, b] : blt::in_pairs(prev, next))
+            {
+                if (!has_converged(a, b))
+                    return false;
+            }
+            return true;
+        }
+        
         weight_t weights;
         std::vector<input_t> inputs;
         std::vector<output_t> outputs;
-        std::vector<std::vector<ping_pong>> steps;
+        std::vector<packed_input_t> packed_inputs;
+        std::vector<packed_output_t> packed_outputs;
+        // owns the step history of the current run, rewound at the start of each execution
+        std::unique_ptr<a1::arena> run_arena = std::make_unique<a1::arena>();
+        // temporaries of the printers, rewound on every call
+        std::unique_ptr<a1::arena> scratch_arena = std::make_unique<a1::arena>();
+        a1::arena_vector<step_t> steps{a1::arena_allocator<step_t>{*run_arena}};
+        // final states of the current run, packed by finish_run()
+        a1::arena_vector<packed_input_t> final_inputs{a1::arena_allocator<packed_input_t>{*run_arena}};
+        a1::arena_vector<packed_output_t> final_outputs{a1::arena_allocator<packed_output_t>{*run_arena}};
+        std::optional<float> energy_tolerance;
 };
 
 // part a
@@ -551,6 +1013,7 @@ void part_a()
     cute.execute_input();
     cute.print_execution_results();
     cute.print_correctness();
+    cute.print_energy();
     if (print_latex)
         cute.print_execution_results_latex();
     
@@ -559,6 +1022,7 @@ void part_a()
     cute.execute_output();
     cute.print_execution_results();
     cute.print_correctness();
+    cute.print_energy();
     if (print_latex)
         cute.print_execution_results_latex();
 }
@@ -574,57 +1038,140 @@ void part_b()
 void part_c()
 {
     blt::log_box_t box(BLT_TRACE_STREAM, "Part C", 8);
+    // each (pattern set, direction) cell is recorded once it finishes so a resumed campaign only runs the missing ones
+    auto run_cell = [](const std::string& name, executor& cute, bool from_inputs) {
+        auto key = "part_c." + name;
+        if (campaign.has(key + ".done"))
+        {
+            correctness_t restored;
+            restored.correct_input = campaign.get_u64(key + ".correct_input");
+            restored.incorrect_input = campaign.get_u64(key + ".incorrect_input");
+            restored.correct_output = campaign.get_u64(key + ".correct_output");
+            restored.incorrect_output = campaign.get_u64(key + ".incorrect_output");
+            // only the counts are checkpointed, the step by step trace is not stored so this cell's output is shorter than a fresh run
+            BLT_WARN("Restored %s from checkpoint, its execution trace and LaTeX table are not repeated", name.c_str());
+            print_correctness(restored);
+            if (from_inputs)
+                cute.print_crosstalk();
+            return;
+        }
+        
+        if (from_inputs)
+            cute.execute_input();
+        else
+            cute.execute_output();
+        cute.print_execution_results();
+        cute.print_correctness();
+        if (from_inputs)
+            cute.print_crosstalk();
+        if (print_latex)
+            cute.print_execution_results_latex_no_intermediates();
+        
+        auto data = cute.correctness();
+        campaign.set(key + ".correct_input", static_cast<blt::u64>(data.correct_input));
+        campaign.set(key + ".incorrect_input", static_cast<blt::u64>(data.incorrect_input));
+        campaign.set(key + ".correct_output", static_cast<blt::u64>(data.correct_output));
+        campaign.set(key + ".incorrect_output", static_cast<blt::u64>(data.incorrect_output));
+        campaign.set(key + ".done", static_cast<blt::u64>(1));
+        campaign.save();
+    };
+    
     executor cute(part_c_1_inputs, part_c_1_outputs);
-    cute.execute_input();
-    cute.print_execution_results();
-    cute.print_correctness();
-    cute.print_crosstalk();
-    if (print_latex)
-        cute.print_execution_results_latex_no_intermediates();
-    cute.execute_output();
-    cute.print_execution_results();
-    cute.print_correctness();
-    if (print_latex)
-        cute.print_execution_results_latex_no_intermediates();
+    run_cell("set_1.inputs", cute, true);
+    run_cell("set_1.outputs", cute, false);
     BLT_TRACE("--- { Part C with 3 extra pairs } ---");
     executor cute2(part_c_2_inputs, part_c_2_outputs);
-    cute2.execute_input();
-    cute2.print_execution_results();
-    cute2.print_correctness();
-    cute2.print_crosstalk();
-    if (print_latex)
-        cute2.print_execution_results_latex_no_intermediates();
-    cute2.execute_output();
-    cute2.print_execution_results();
-    cute2.print_correctness();
-    if (print_latex)
-        cute2.print_execution_results_latex_no_intermediates();
-}
-
-blt::size_t hdist(const input_t& a, const input_t& b)
-{
-    blt::size_t diff = 0;
-    for (auto [av, bv] : blt::in_pairs(a.vec_from_column_row(), b.vec_from_column_row()))
-        diff += (av != bv ? 1 : 0);
-    return diff;
+    run_cell("set_2.inputs", cute2, true);
+    run_cell("set_2.outputs", cute2, false);
 }
 
 void part_d()
 {
     blt::log_box_t box(BLT_TRACE_STREAM, "Part D", 8);
-    blt::random::random_t random(std::random_device{}());
     executor cute(part_a_inputs, part_a_outputs);
-    constexpr blt::size_t number_of_runs = 80;
-    std::vector<blt::size_t> mutations;
-    std::vector<blt::size_t> corrections;
-    blt::size_t total_corrections = 0;
-    blt::size_t total_mutations = 0;
-    blt::size_t min_corrections = std::numeric_limits<blt::size_t>::max();
-    blt::size_t max_corrections = 0;
-    blt::size_t min_mutations = std::numeric_limits<blt::size_t>::max();
-    blt::size_t max_mutations = 0;
-    for (blt::size_t run = 0; run < number_of_runs; run++)
+    constexpr blt::size_t number_of_runs = part_d_runs;
+    static_assert(packed_input_t::word_count == 1, "part D checkpoint logs store each vector as a single word");
+    
+    // every run draws from its own stream derived from the base seed, so the seed and the next run index are the entire RNG state
+    if (!campaign.has("part_d.seed"))
+        campaign.set("part_d.seed", static_cast<blt::u64>(std::random_device{}()));
+    auto seed = campaign.get_u64("part_d.seed");
+    blt::size_t first_run = campaign.get_u64("part_d.next_run");
+    
+    a1::running_stats mutation_stats;
+    a1::running_stats correction_stats;
+    mutation_stats.load(campaign, "part_d.mutations");
+    correction_stats.load(campaign, "part_d.corrections");
+    std::array<blt::size_t, input_vec_size + 1> mutation_histogram{};
+    std::array<blt::size_t, input_vec_size + 1> correction_histogram{};
+    for (blt::size_t distance = 0; distance < mutation_histogram.size(); distance++)
     {
+        mutation_histogram[distance] = campaign.get_u64("part_d.mutation_histogram." + std::to_string(distance));
+        correction_histogram[distance] = campaign.get_u64("part_d.correction_histogram." + std::to_string(distance));
+    }
+    
+    auto print_run = [](blt::size_t run, const input_t& original, const input_t& modified, blt::size_t dist_o_m, const input_t& corrected,
+                        blt::size_t dist_o_c) {
+        if (print_latex)
+        {
+            std::cout << run + 1 << " & ";
+            print_vec_square(std::cout, original.vec_from_column_row()) << " & ";
+            print_vec_square(std::cout, modified.vec_from_column_row()) << " & ";
+            std::cout << dist_o_m << " & ";
+            print_vec_square(std::cout, corrected.vec_from_column_row()) << " & ";
+            std::cout << dist_o_c << " \\\\ \n\\hline\n";
+        } else
+        {
+            BLT_TRACE_STREAM << "Run " << run << " " << original.vec_from_column_row() << " || mutated " << modified.vec_from_column_row()
+                             << " difference: " << dist_o_m << " || corrected " << corrected.vec_from_column_row() << " || difference: "
+                             << dist_o_c << "\n";
+        }
+    };
+    
+    // every finished run appends its three vectors to the checkpoint log, so the rows before the resume point are printed as they were.
+    // rows at or past the resume point were logged before an interrupted save and are run again, a repeated run logs the same row
+    if (first_run > 0)
+    {
+        BLT_INFO("Resuming Part D at run %ld of %ld", first_run, number_of_runs);
+        std::vector<std::optional<std::array<packed_input_t, 3>>> restored(first_run);
+        for (const auto& line : campaign.read_log())
+        {
+            unsigned long long run, original, modified, corrected;
+            if (std::sscanf(line.c_str(), "part_d %llu %llx %llx %llx", &run, &original, &modified, &corrected) != 4 || run >= first_run)
+                continue;
+            restored[run] = std::array<packed_input_t, 3>{};
+            (*restored[run])[0].words[0] = original;
+            (*restored[run])[1].words[0] = modified;
+            (*restored[run])[2].words[0] = corrected;
+        }
+        blt::size_t missing = 0;
+        for (auto [run, row] : blt::enumerate(restored))
+        {
+            if (!row)
+            {
+                missing++;
+                continue;
+            }
+            auto& [original, modified, corrected] = *row;
+            print_run(run, a1::unpack(original), a1::unpack(modified), a1::hamming(original, modified), a1::unpack(corrected),
+                      a1::hamming(original, corrected));
+        }
+        if (missing > 0)
+            BLT_WARN("%ld of the %ld finished Part D runs are missing from the checkpoint log and are not printed", missing, first_run);
+    }
+    
+    // every remaining probe is drawn and corrected up front so the workers are forked once for the whole batch, the chunks below only
+    // decide how often the results are checkpointed
+    auto remaining = number_of_runs - std::min(first_run, number_of_runs);
+    // backs every buffer of the batch, released in one go when part D returns
+    a1::arena part_d_arena;
+    a1::arena_vector<input_t> originals{a1::arena_allocator<input_t>{part_d_arena}};
+    a1::arena_vector<input_t> modifications{a1::arena_allocator<input_t>{part_d_arena}};
+    originals.reserve(remaining);
+    modifications.reserve(remaining);
+    for (blt::size_t run = first_run; run < number_of_runs; run++)
+    {
+        blt::random::random_t random(a1::stream_seed(seed, run));
         auto pos = random.get_size_t(0, part_a_inputs.size());
         auto original = part_a_inputs[pos];
         auto modified = original;
@@ -640,77 +1187,381 @@ void part_d()
                     d = 1;
             }
         }
-        auto corrected = cute.correct(modified);
-        
-        auto dist_o_m = hdist(original, modified);
-        auto dist_o_c = hdist(original, corrected);
-        
-        corrections.push_back(dist_o_c);
-        mutations.push_back(dist_o_m);
-        total_corrections += dist_o_c;
-        total_mutations += dist_o_m;
-        
-        min_corrections = std::min(dist_o_c, min_corrections);
-        max_corrections = std::max(dist_o_c, max_corrections);
-        
-        min_mutations = std::min(dist_o_m, min_mutations);
-        max_mutations = std::max(dist_o_m, max_mutations);
-        
-        if (print_latex)
+        originals.push_back(original);
+        modifications.push_back(modified);
+    }
+    // the noisy probes are independent of each other so they are corrected as one batch
+    a1::arena_vector<input_t> corrections_batch{a1::arena_allocator<input_t>{part_d_arena}};
+    corrections_batch.resize(remaining);
+    cute.correct_sharded(modifications.data(), remaining, corrections_batch.data(), worker_count);
+    
+    a1::arena_vector<packed_input_t> packed_originals{a1::arena_allocator<packed_input_t>{part_d_arena}};
+    a1::arena_vector<packed_input_t> packed_modifications{a1::arena_allocator<packed_input_t>{part_d_arena}};
+    a1::arena_vector<packed_input_t> packed_corrections{a1::arena_allocator<packed_input_t>{part_d_arena}};
+    packed_originals.reserve(remaining);
+    packed_modifications.reserve(remaining);
+    packed_corrections.reserve(remaining);
+    for (blt::size_t i = 0; i < remaining; i++)
+    {
+        packed_originals.push_back(a1::pack(originals[i]));
+        packed_modifications.push_back(a1::pack(modifications[i]));
+        packed_corrections.push_back(a1::pack(corrections_batch[i]));
+    }
+    a1::arena_vector<blt::u32> mutations{a1::arena_allocator<blt::u32>{part_d_arena}};
+    a1::arena_vector<blt::u32> corrections{a1::arena_allocator<blt::u32>{part_d_arena}};
+    mutations.resize(remaining);
+    corrections.resize(remaining);
+    a1::hamming_pairs(packed_originals.data(), packed_modifications.data(), remaining, mutations.data());
+    a1::hamming_pairs(packed_originals.data(), packed_corrections.data(), remaining, corrections.data());
+    
+    for (blt::size_t chunk_begin = 0; chunk_begin < remaining; chunk_begin += checkpoint_interval)
+    {
+        auto chunk_end = std::min(chunk_begin + checkpoint_interval, remaining);
+        std::string log_rows;
+        for (blt::size_t i = chunk_begin; i < chunk_end; i++)
         {
-            std::cout << run + 1 << " & ";
-            print_vec_square(std::cout, original.vec_from_column_row()) << " & ";
-            print_vec_square(std::cout, modified.vec_from_column_row()) << " & ";
-            std::cout << dist_o_m << " & ";
-            print_vec_square(std::cout, corrected.vec_from_column_row()) << " & ";
-            std::cout << dist_o_c << " \\\\ \n\\hline\n";
-        } else
+            auto run = first_run + i;
+            auto& original = originals[i];
+            auto& modified = modifications[i];
+            auto& corrected = corrections_batch[i];
+            
+            blt::size_t dist_o_m = mutations[i];
+            blt::size_t dist_o_c = corrections[i];
+            
+            mutation_stats.push(static_cast<double>(dist_o_m));
+            correction_stats.push(static_cast<double>(dist_o_c));
+            mutation_histogram[dist_o_m]++;
+            correction_histogram[dist_o_c]++;
+            
+            print_run(run, original, modified, dist_o_m, corrected, dist_o_c);
+            
+            char row[96];
+            std::snprintf(row, sizeof(row), "part_d %llu %llx %llx %llx\n", static_cast<unsigned long long>(run),
+                          static_cast<unsigned long long>(packed_originals[i].words[0]),
+                          static_cast<unsigned long long>(packed_modifications[i].words[0]),
+                          static_cast<unsigned long long>(packed_corrections[i].words[0]));
+            log_rows += row;
+        }
+        
+        // the rows go out before the resume point moves past them, so an interruption in between only repeats them
+        campaign.append_log(log_rows);
+        campaign.set("part_d.next_run", static_cast<blt::u64>(first_run + chunk_end));
+        mutation_stats.save(campaign, "part_d.mutations");
+        correction_stats.save(campaign, "part_d.corrections");
+        for (blt::size_t distance = 0; distance < mutation_histogram.size(); distance++)
         {
-            BLT_TRACE_STREAM << "Run " << run << " " << original.vec_from_column_row() << " || mutated " << modified.vec_from_column_row()
-                             << " difference: " << dist_o_m << " || corrected " << corrected.vec_from_column_row() << " || difference: " << dist_o_c
-                             << "\n";
+            campaign.set("part_d.mutation_histogram." + std::to_string(distance), static_cast<blt::u64>(mutation_histogram[distance]));
+            campaign.set("part_d.correction_histogram." + std::to_string(distance), static_cast<blt::u64>(correction_histogram[distance]));
         }
+        campaign.save();
     }
-    double mean_corrections = static_cast<double>(total_corrections) / number_of_runs;
-    double mean_mutations = static_cast<double>(total_mutations) / number_of_runs;
     
-    double stddev_corrections = 0;
-    double stddev_mutations = 0;
+    std::cout << "Mean Distance Corrections: " << correction_stats.mean << " Stddev: " << correction_stats.stddev() << " Min: "
+              << static_cast<blt::size_t>(correction_stats.min) << " Max: " << static_cast<blt::size_t>(correction_stats.max) << '\n';
+    std::cout << "Mean Distance Mutations: " << mutation_stats.mean << " Stddev: " << mutation_stats.stddev() << " Min: "
+              << static_cast<blt::size_t>(mutation_stats.min) << " Max: " << static_cast<blt::size_t>(mutation_stats.max) << '\n';
     
-    for (const auto& v : corrections)
+    std::cout << "Distance Histogram (distance: mutations / corrections):";
+    for (blt::size_t distance = 0; distance < mutation_histogram.size(); distance++)
+        std::cout << ' ' << distance << ": " << mutation_histogram[distance] << " / " << correction_histogram[distance];
+    std::cout << '\n';
+}
+
+// every bipolar input vector, so benchmarks cover every basin rather than a random sample
+std::vector<input_t> all_input_probes()
+{
+    std::vector<input_t> probes;
+    for (blt::size_t bits = 0; bits < (1ul << input_vec_size); bits++)
     {
-        auto x = (static_cast<double>(v) - mean_corrections);
-        stddev_corrections += x * x;
+        input_t probe;
+        for (blt::size_t i = 0; i < input_vec_size; i++)
+            probe[i][0] = (bits >> i) & 1 ? 1.0f : -1.0f;
+        probes.push_back(probe);
     }
+    return probes;
+}
+
+// stored pattern sets the benchmarks run against, part A and both part C sets
+std::vector<std::pair<std::vector<input_t>, std::vector<output_t>>> benchmark_pattern_sets()
+{
+    return {
+            {part_a_inputs, part_a_outputs},
+            {part_c_1_inputs, part_c_1_outputs},
+            {part_c_2_inputs, part_c_2_outputs}
+    };
+}
+
+void benchmark_schedules()
+{
+    blt::log_box_t box(BLT_TRACE_STREAM, "Update Schedule Benchmark", 8);
+    struct schedule_case_t
+    {
+        std::string name;
+        update_schedule_t schedule;
+        blt::size_t block_size;
+        // stop once the energy settles instead of waiting for the states to repeat
+        std::optional<float> energy_tolerance;
+    };
+    const std::vector<schedule_case_t> schedules{
+            {"Synchronous", update_schedule_t::SYNCHRONOUS, 1, {}},
+            {"Asynchronous", update_schedule_t::ASYNCHRONOUS, 1, {}},
+            {"Block-sequential (2)", update_schedule_t::BLOCK_SEQUENTIAL, 2, {}},
+            {"Block-sequential (3)", update_schedule_t::BLOCK_SEQUENTIAL, 3, {}},
+            {"Synchronous, dE <= 2", update_schedule_t::SYNCHRONOUS, 1, 2.0f},
+            {"Asynchronous, dE <= 2", update_schedule_t::ASYNCHRONOUS, 1, 2.0f},
+    };
+    const auto pattern_sets = benchmark_pattern_sets();
     
-    for (const auto& v : mutations)
+    auto probes = all_input_probes();
+    
+    for (auto [set_index, set] : blt::enumerate(pattern_sets))
     {
-        auto x = (static_cast<double>(v) - mean_mutations);
-        stddev_mutations += x * x;
+        auto& [inputs, outputs] = set;
+        BLT_TRACE("Pattern set %ld (%ld pairs):", set_index + 1, inputs.size());
+        executor cute(inputs, outputs);
+        for (const auto& c : schedules)
+        {
+            if (c.energy_tolerance)
+                cute.set_energy_tolerance(*c.energy_tolerance);
+            else
+                cute.clear_energy_tolerance();
+            cute.execute_input(c.schedule, c.block_size);
+            auto input_operations = cute.total_operations();
+            auto input_correct = cute.correctness().correct_input;
+            cute.execute_output(c.schedule, c.block_size);
+            auto output_operations = cute.total_operations();
+            auto output_correct = cute.correctness().correct_output;
+            
+            blt::size_t probe_operations = 0;
+            blt::size_t probe_max_operations = 0;
+            for (const auto& probe : probes)
+            {
+                auto operations = cute.recall(probe, c.schedule, c.block_size).get_operations();
+                probe_operations += operations;
+                probe_max_operations = std::max(probe_max_operations, operations);
+            }
+            
+            BLT_TRACE("\t%-22s | stored from inputs: %5ld ops (%ld correct) | from outputs: %5ld ops (%ld correct) | probes: mean %.2lf max %ld ops",
+                      c.name.c_str(), input_operations, input_correct, output_operations, output_correct,
+                      static_cast<double>(probe_operations) / static_cast<double>(probes.size()), probe_max_operations);
+        }
     }
+}
+
+void benchmark_sparse()
+{
+    blt::log_box_t box(BLT_TRACE_STREAM, "Sparse Weight Benchmark", 8);
+    constexpr blt::size_t repetitions = 10000;
+    const auto pattern_sets = benchmark_pattern_sets();
     
-    stddev_corrections /= number_of_runs;
-    stddev_mutations /= number_of_runs;
+    auto probes = all_input_probes();
     
-    stddev_corrections = std::sqrt(stddev_corrections);
-    stddev_mutations = std::sqrt(stddev_mutations);
+    for (auto [set_index, set] : blt::enumerate(pattern_sets))
+    {
+        auto& [inputs, outputs] = set;
+        BLT_TRACE("Pattern set %ld (%ld pairs):", set_index + 1, inputs.size());
+        executor cute(inputs, outputs);
+        
+        std::vector<input_t> dense_results;
+        float checksum = 0;
+        auto dense_start = std::chrono::steady_clock::now();
+        for (blt::size_t r = 0; r < repetitions; r++)
+        {
+            for (const auto& probe : probes)
+            {
+                auto result = cute.correct_dense(probe);
+                checksum += result[0][0];
+                if (r == 0)
+                    dense_results.push_back(result);
+            }
+        }
+        auto dense_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - dense_start).count();
+        BLT_TRACE("\tDense            | %4ld bytes | %10.0lf recalls/s", sparse_weight_t::dense_bytes(),
+                  static_cast<double>(repetitions * probes.size()) / dense_time);
+        
+        for (float threshold : {0.0f, 1.0f, 2.0f})
+        {
+            auto sparse = cute.make_sparse_weights(threshold);
+            blt::size_t agreements = 0;
+            auto sparse_start = std::chrono::steady_clock::now();
+            for (blt::size_t r = 0; r < repetitions; r++)
+            {
+                for (auto [probe_index, probe] : blt::enumerate(probes))
+                {
+                    auto result = cute.correct_sparse(probe, sparse);
+                    checksum += result[0][0];
+                    if (r == 0 && result == dense_results[probe_index])
+                        agreements++;
+                }
+            }
+            auto sparse_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - sparse_start).count();
+            if (threshold == 0.0f)
+                BLT_ASSERT(agreements == probes.size() && "UNPRUNED SPARSE RECALL DISAGREES WITH DENSE");
+            BLT_TRACE("\tSparse (|w| > %.0f) | %4ld bytes | %10.0lf recalls/s | density %.2lf | agrees with dense on %ld/%ld probes",
+                      threshold, sparse.sparse_bytes(), static_cast<double>(repetitions * probes.size()) / sparse_time, sparse.density(),
+                      agreements, probes.size());
+        }
+        BLT_TRACE("\t(checksum %f)", checksum);
+    }
+}
+
+// everything a checkpoint's contents depend on, a checkpoint written under a different configuration must not be merged
+std::string campaign_config()
+{
+    // FNV-1a over the signs of every stored pattern
+    blt::u64 fingerprint = 0xcbf29ce484222325ull;
+    auto mix = [&fingerprint](float value) {
+        fingerprint ^= value >= 0 ? 1u : 0u;
+        fingerprint *= 0x100000001b3ull;
+    };
+    for (const auto& patterns : {part_a_inputs, part_c_1_inputs, part_c_2_inputs})
+    {
+        for (const auto& v : patterns)
+            for (blt::size_t i = 0; i < input_vec_size; i++)
+                mix(v[i][0]);
+        mix(0); // separates the sets so moving a pattern between them changes the fingerprint
+    }
+    for (const auto& patterns : {part_a_outputs, part_c_1_outputs, part_c_2_outputs})
+    {
+        for (const auto& v : patterns)
+            for (blt::size_t i = 0; i < output_vec_size; i++)
+                mix(v[i][0]);
+        mix(0);
+    }
+    char buffer[128];
+    std::snprintf(buffer, sizeof(buffer), "runs=%ld,sets=%ld/%ld/%ld,patterns=%016lx", part_d_runs, part_a_inputs.size(),
+                  part_c_1_inputs.size(), part_c_2_inputs.size(), fingerprint);
+    return buffer;
+}
+
+// which stored pattern every possible probe recalls, read off the probes x patterns distance matrices of the probes and their results
+void benchmark_basins()
+{
+    blt::log_box_t box(BLT_TRACE_STREAM, "Basin Map", 8);
+    const auto pattern_sets = benchmark_pattern_sets();
+    auto probes = all_input_probes();
+    a1::arena basin_arena;
     
-    std::cout << "Mean Distance Corrections: " << mean_corrections << " Stddev: " << stddev_corrections << " Min: " << min_corrections << " Max: "
-              << max_corrections << '\n';
-    std::cout << "Mean Distance Mutations: " << mean_mutations << " Stddev: " << stddev_mutations << " Min: " << min_mutations << " Max: "
-              << max_mutations << '\n';
+    for (auto [set_index, set] : blt::enumerate(pattern_sets))
+    {
+        auto& [inputs, outputs] = set;
+        executor cute(inputs, outputs);
+        auto patterns = cute.pattern_count();
+        
+        basin_arena.reset();
+        a1::arena_vector<input_t> recalled{a1::arena_allocator<input_t>{basin_arena}};
+        recalled.resize(probes.size());
+        cute.correct_sharded(probes.data(), probes.size(), recalled.data(), worker_count);
+        
+        a1::arena_vector<packed_input_t> packed_probes{a1::arena_allocator<packed_input_t>{basin_arena}};
+        a1::arena_vector<packed_input_t> packed_recalled{a1::arena_allocator<packed_input_t>{basin_arena}};
+        packed_probes.reserve(probes.size());
+        packed_recalled.reserve(probes.size());
+        for (blt::size_t p = 0; p < probes.size(); p++)
+        {
+            packed_probes.push_back(a1::pack(probes[p]));
+            packed_recalled.push_back(a1::pack(recalled[p]));
+        }
+        
+        a1::arena_vector<blt::u32> probe_distances{a1::arena_allocator<blt::u32>{basin_arena}};
+        a1::arena_vector<blt::u32> recalled_distances{a1::arena_allocator<blt::u32>{basin_arena}};
+        probe_distances.resize(probes.size() * patterns);
+        recalled_distances.resize(probes.size() * patterns);
+        cute.distance_matrix(packed_probes.data(), probes.size(), probe_distances.data());
+        cute.distance_matrix(packed_recalled.data(), probes.size(), recalled_distances.data());
+        
+        a1::arena_vector<blt::size_t> basin_sizes{a1::arena_allocator<blt::size_t>{basin_arena}};
+        basin_sizes.resize(patterns);
+        blt::size_t nearest = 0;
+        blt::size_t spurious = 0;
+        for (blt::size_t p = 0; p < probes.size(); p++)
+        {
+            auto probe_row = probe_distances.data() + p * patterns;
+            auto recalled_row = recalled_distances.data() + p * patterns;
+            auto stored = static_cast<blt::size_t>(std::find(recalled_row, recalled_row + patterns, 0u) - recalled_row);
+            if (stored == patterns)
+            {
+                spurious++;
+                continue;
+            }
+            basin_sizes[stored]++;
+            // ties count, the probe recalled one of the stored inputs closest to it
+            if (probe_row[stored] == *std::min_element(probe_row, probe_row + patterns))
+                nearest++;
+        }
+        auto movement = a1::hamming_histogram(packed_probes.data(), packed_recalled.data(), probes.size());
+        
+        BLT_TRACE("Pattern set %ld (%ld pairs): %ld/%ld probes recall a stored input, %ld of them a nearest one, %ld settle on a spurious state",
+                  set_index + 1, patterns, probes.size() - spurious, probes.size(), nearest, spurious);
+        BLT_TRACE_STREAM << "\tBasin size of each stored input:";
+        for (auto size : basin_sizes)
+            BLT_TRACE_STREAM << ' ' << size;
+        BLT_TRACE_STREAM << "\n\tProbes moved by each distance:";
+        for (blt::size_t distance = 0; distance < movement.size(); distance++)
+            BLT_TRACE_STREAM << ' ' << distance << ": " << movement[distance];
+        BLT_TRACE_STREAM << "\n";
+    }
+}
+
+// positive integer given on the command line, anything else (including signs and overflow) is rejected
+std::optional<blt::size_t> parse_count(const std::string& value)
+{
+    if (value.empty() || !std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); }))
+        return {};
+    errno = 0;
+    auto count = std::strtoull(value.c_str(), nullptr, 10);
+    if (errno == ERANGE || count == 0)
+        return {};
+    return static_cast<blt::size_t>(count);
 }
 
 int main(int argc, const char** argv)
 {
     blt::arg_parse parser;
     parser.addArgument(blt::arg_builder{"--latex", "-l"}.setAction(blt::arg_action_t::STORE_TRUE).setDefault(false).build());
+    parser.addArgument(blt::arg_builder{"--bench", "-b"}.setAction(blt::arg_action_t::STORE_TRUE).setDefault(false).build());
+    parser.addArgument(blt::arg_builder{"--workers", "-w"}.setDefault(std::string{"1"}).build());
+    parser.addArgument(blt::arg_builder{"--checkpoint", "-c"}.setDefault(std::string{}).build());
+    parser.addArgument(blt::arg_builder{"--interval", "-i"}.setDefault(std::string{"10"}).build());
     
     auto args = parser.parse_args(argc, argv);
     print_latex = blt::arg_parse::get<bool>(args["latex"]);
+    auto run_benchmarks = blt::arg_parse::get<bool>(args["bench"]);
+    auto workers = parse_count(blt::arg_parse::get<std::string>(args["workers"]));
+    if (!workers)
+    {
+        BLT_ERROR("--workers expects a positive integer, got '%s'", blt::arg_parse::get<std::string>(args["workers"]).c_str());
+        return 1;
+    }
+    worker_count = *workers;
+    auto interval = parse_count(blt::arg_parse::get<std::string>(args["interval"]));
+    if (!interval)
+    {
+        BLT_ERROR("--interval expects a positive integer, got '%s'", blt::arg_parse::get<std::string>(args["interval"]).c_str());
+        return 1;
+    }
+    checkpoint_interval = *interval;
+    campaign = a1::checkpoint{blt::arg_parse::get<std::string>(args["checkpoint"])};
+    auto config = campaign_config();
+    auto loaded = campaign.load();
+    if (loaded == a1::load_result_t::INVALID)
+        return 1;
+    if (loaded == a1::load_result_t::RESUMED)
+    {
+        auto recorded = campaign.get("config");
+        if (recorded != config)
+        {
+            BLT_ERROR("Checkpoint '%s' was written with configuration '%s' but this run uses '%s', remove it or choose another path",
+                      blt::arg_parse::get<std::string>(args["checkpoint"]).c_str(), recorded.c_str(), config.c_str());
+            return 1;
+        }
+        BLT_INFO("Resuming from checkpoint '%s'", blt::arg_parse::get<std::string>(args["checkpoint"]).c_str());
+    }
+    campaign.set("config", config);
     
     blt::logging::setLogOutputFormat("\033[94m[${{TIME}}]${{RC}} \033[35m(${{FILE}}:${{LINE}})${{RC}} ${{LF}}${{CNR}}${{STR}}${{RC}}\n");
     a1::test_math();
+    a1::test_sparse();
     
     part_a();
     part_b();
@@ -720,4 +1571,11 @@ int main(int argc, const char** argv)
     std::vector<input_t> test{input_t{1, -1, -1, -1, -1}, input_t{-1, 1, -1, -1, -1}, input_t{-1, -1, 1, -1, -1}};
     executor cute{test, part_a_outputs};
     cute.print_crosstalk();
+    
+    if (run_benchmarks)
+    {
+        benchmark_schedules();
+        benchmark_sparse();
+        benchmark_basins();
+    }
 }